@@ -0,0 +1,86 @@
+// 数字分类器基准：同一个 mlp.onnx 分别走 OpenVINO（ai::sharedCore）与 cv::dnn 后端
+// 用法：bench_classifier [assets_dir [batch iterations]]
+// 输入为合成的 20x28 Otsu 二值数字图，每次 classify 一批 batch 块装甲板（对应一帧）；
+// 同时报告两个后端的类别一致率与置信度最大差
+#include "detector/traditional/number_classifier.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Classifier = rm_auto_aim::NumberClassifier;
+using Backend    = Classifier::Backend;
+
+template <class F>
+double medianMs(int iters, F&& f) {
+    std::vector<double> t(iters);
+    for (int i = 0; i < iters; ++i) {
+        const auto t0 = std::chrono::steady_clock::now();
+        f();
+        const auto t1 = std::chrono::steady_clock::now();
+        t[i]          = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    }
+    std::nth_element(t.begin(), t.begin() + iters / 2, t.end());
+    return t[iters / 2];
+}
+
+// 与 NumberClassifier::extractNumbers 的输出同形：20x28 单通道，0 / 255
+cv::Mat synthNumber(cv::RNG& rng) {
+    cv::Mat img(28, 20, CV_8UC1);
+    rng.fill(img, cv::RNG::NORMAL, cv::Scalar(40), cv::Scalar(20));
+    cv::putText(
+        img, std::to_string(rng.uniform(1, 6)), {rng.uniform(2, 6), rng.uniform(20, 25)},
+        cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(220), 2);
+    cv::threshold(img, img, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+    return img;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string assets = argc > 1 ? argv[1] : "assets";
+    const int batch          = argc > 3 ? std::max(1, std::atoi(argv[2])) : 10;
+    const int iters          = argc > 3 ? std::max(1, std::atoi(argv[3])) : 500;
+    const std::string model  = assets + "/models/mlp.onnx";
+    const std::string label  = assets + "/models/label.txt";
+
+    cv::RNG rng(42);
+    std::vector<rm_auto_aim::Armor> armors(batch);
+    for (auto& armor : armors)
+        armor.number_img = synthNumber(rng);
+
+    Classifier ov_classifier(model, label, 0.8, {"negative"}, Backend::OpenVINO);
+    Classifier dnn_classifier(model, label, 0.8, {"negative"}, Backend::OpenCV);
+    if (ov_classifier.backend() != Backend::OpenVINO) {
+        std::fprintf(stderr, "OpenVINO backend unavailable\n");
+        return 1;
+    }
+
+    // 各自预热一次，顺便拿结果做一致性对比
+    auto ov_armors = armors, dnn_armors = armors;
+    ov_classifier.classify(ov_armors);
+    dnn_classifier.classify(dnn_armors);
+    int agree        = 0;
+    double conf_diff = 0;
+    for (int i = 0; i < batch; ++i) {
+        agree += ov_armors[i].number == dnn_armors[i].number;
+        conf_diff = std::max(
+            conf_diff, double(std::abs(ov_armors[i].confidence - dnn_armors[i].confidence)));
+    }
+
+    const double ov_ms  = medianMs(iters, [&] { ov_classifier.classify(ov_armors); });
+    const double dnn_ms = medianMs(iters, [&] { dnn_classifier.classify(dnn_armors); });
+    std::printf("batch %d, %d iterations (median per classify call)\n", batch, iters);
+    std::printf("  openvino : %8.4f ms  (%.4f ms / armor)\n", ov_ms, ov_ms / batch);
+    std::printf("  cv::dnn  : %8.4f ms  (%.4f ms / armor)\n", dnn_ms, dnn_ms / batch);
+    std::printf("  agree    : %d / %d, max |confidence diff| %.2e\n", agree, batch, conf_diff);
+    return agree == batch ? 0 : 2;
+}
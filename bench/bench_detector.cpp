@@ -0,0 +1,521 @@
+// 检测器基准：AI 路径（ai::Detector）与传统路径（rm_auto_aim::Detector）的分阶段耗时
+// 用法：bench_detector [--images DIR | --synthetic N] [--assets DIR] [--iterations K] [--out FILE]
+//       [--tile N [--tile-overlap M] [--tile-batched]] [--input-size S]
+//       [--binary-thres T] [--color-diff-thres T]：传统路径灰度 / 色差二值化阈值，两条都计时
+//       [--verify]：不计时，改为逐项对比优化前后的实现（录制帧用 --images），有差异时退出码为 2
+// 结果写成 JSON：每阶段 p50/p95/p99/mean（毫秒）、吞吐（张/秒）与峰值 RSS，便于前后对比
+#include "detector/ai/detector.hpp"
+#include "detector/traditional/detector.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msBetween(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+// 峰值常驻内存（KB，Linux 下 ru_maxrss 单位即 KB）
+long peakRssKb() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+}
+
+// 按固定顺序记录的若干阶段耗时序列
+class StageStats {
+public:
+    explicit StageStats(std::vector<QString> names)
+        : names_(std::move(names))
+        , ms_(names_.size()) {}
+
+    void add(size_t stage, double ms) { ms_[stage].push_back(ms); }
+
+    QJsonObject toJson() {
+        QJsonObject o;
+        for (size_t i = 0; i < names_.size(); ++i) {
+            auto& v = ms_[i];
+            if (v.empty())
+                continue;
+            std::sort(v.begin(), v.end());
+            QJsonObject s;
+            s["p50"]     = percentile(v, 50);
+            s["p95"]     = percentile(v, 95);
+            s["p99"]     = percentile(v, 99);
+            s["mean"]    = std::accumulate(v.begin(), v.end(), 0.0) / double(v.size());
+            s["n"]       = qint64(v.size());
+            o[names_[i]] = s;
+        }
+        return o;
+    }
+
+private:
+    // 最近秩法求分位数，v 需已排序
+    static double percentile(const std::vector<double>& v, double p) {
+        const size_t k = size_t(std::ceil(p / 100.0 * v.size()));
+        return v[std::clamp<size_t>(k, 1, v.size()) - 1];
+    }
+
+    std::vector<QString> names_;
+    std::vector<std::vector<double>> ms_;
+};
+
+void fillRotated(cv::Mat& img, const cv::RotatedRect& r, const cv::Scalar& color) {
+    cv::Point2f p[4];
+    r.points(p);
+    const cv::Point q[4] = {p[0], p[1], p[2], p[3]};
+    cv::fillConvexPoly(img, q, 4, color, cv::LINE_AA);
+}
+
+// 合成测试图（BGR）：暗背景 + 噪声，随机摆放几块“装甲板”——两根红/蓝灯条夹一块带数字的灰色面板。
+// 只求让两条检测路径都走到完整流程，不追求逼真；同一 seed 生成的图完全一致
+cv::Mat synthArmorImage(cv::RNG& rng, cv::Size size) {
+    cv::Mat img(size, CV_8UC3);
+    rng.fill(img, cv::RNG::NORMAL, cv::Scalar::all(30), cv::Scalar::all(12));
+
+    const int n = rng.uniform(1, 5);
+    for (int k = 0; k < n; ++k) {
+        const bool red    = rng.uniform(0, 2) == 0;
+        const float len   = rng.uniform(20.f, 80.f);
+        const float gap   = len * rng.uniform(1.6f, 2.6f); // 灯条中心距，落在小装甲板范围内
+        const float angle = rng.uniform(-15.f, 15.f);
+        const float rad   = angle * float(CV_PI) / 180.f;
+        const cv::Point2f c(
+            rng.uniform(gap, size.width - gap), rng.uniform(len, size.height - len));
+
+        fillRotated(img, cv::RotatedRect(c, {gap * 0.8f, len * 1.6f}, angle), cv::Scalar::all(90));
+        cv::putText(
+            img, std::to_string(rng.uniform(1, 6)), c + cv::Point2f(-len * 0.2f, len * 0.25f),
+            cv::FONT_HERSHEY_SIMPLEX, len / 40.0, cv::Scalar::all(200), 2);
+
+        const cv::Scalar halo = red ? cv::Scalar(60, 60, 255) : cv::Scalar(255, 120, 40);
+        const cv::Scalar core = red ? cv::Scalar(220, 220, 255) : cv::Scalar(255, 235, 220);
+        for (const float side : {-0.5f, 0.5f}) {
+            const cv::Point2f lc = c + cv::Point2f(std::cos(rad), std::sin(rad)) * (gap * side);
+            fillRotated(img, cv::RotatedRect(lc, {len * 0.22f, len}, angle), halo);
+            fillRotated(img, cv::RotatedRect(lc, {len * 0.09f, len * 0.9f}, angle), core);
+        }
+    }
+    cv::GaussianBlur(img, img, {3, 3}, 0);
+    return img;
+}
+
+std::vector<cv::Mat> loadImages(const QString& dir, int limit) {
+    std::vector<cv::Mat> images;
+    QDirIterator it(
+        dir, {"*.jpg", "*.jpeg", "*.png", "*.bmp"}, QDir::Files, QDirIterator::Subdirectories);
+    QStringList paths;
+    while (it.hasNext())
+        paths << it.next();
+    paths.sort();
+    for (const QString& p : paths) {
+        if (int(images.size()) >= limit)
+            break;
+        cv::Mat img = cv::imread(p.toStdString(), cv::IMREAD_COLOR);
+        if (!img.empty())
+            images.push_back(std::move(img));
+    }
+    return images;
+}
+
+QJsonObject benchAi(
+    const std::vector<cv::Mat>& images, const QString& assets, int iterations,
+    const ai::Detector::TileParams& tiles, int input_size) {
+    QJsonObject o;
+    ai::Detector detector;
+    detector.setTileParams(tiles);
+    detector.setInputSize(input_size);
+    detector.setupModel(assets);
+    if (!detector.ready()) {
+        o["error"] = QString("model not found under %1/models").arg(assets);
+        return o;
+    }
+    o["mode"]       = detector.mode() == ai::Detector::Mode::OV_INT8_CPU ? "int8" : "fp32";
+    o["pool"]       = detector.poolSize();
+    o["input_size"] = detector.inputSize();
+    if (tiles.enabled) {
+        const auto tp = detector.tileParams();
+        o["tile"]     = QJsonObject{
+            {"size", tp.tile}, {"overlap", tp.overlap}, {"batched", tp.batched}};
+    }
+
+    // 预热：首次推理包含懒初始化
+    for (size_t i = 0; i < std::min<size_t>(3, images.size()); ++i)
+        detector.detect(images[i]);
+
+    StageStats stats({"preprocess", "infer", "decode", "nms", "total"});
+    qint64 detections = 0;
+    const auto start  = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        for (const auto& img : images) {
+            ai::Detector::StageTimes t;
+            const auto t0 = Clock::now();
+            detections += detector.detect(img, &t).size();
+            const auto t1 = Clock::now();
+            // 分块时各块并行，分阶段耗时没有意义，只记总耗时
+            if (!tiles.enabled) {
+                stats.add(0, t.preprocess);
+                stats.add(1, t.infer);
+                stats.add(2, t.decode);
+                stats.add(3, t.nms);
+            }
+            stats.add(4, msBetween(t0, t1));
+        }
+    }
+    const double sec = msBetween(start, Clock::now()) / 1000.0;
+
+    o["stages"]         = stats.toJson();
+    o["images_per_sec"] = double(images.size()) * iterations / sec;
+    o["detections"]     = detections;
+    o["peak_rss_kb"]    = qint64(peakRssKb());
+    return o;
+}
+
+// 传统路径逐阶段计时；threshold / findLights 两段按 detector.l.binarization 走灰度或色差
+QJsonObject timeTraditional(
+    const rm_auto_aim::Detector& detector, const std::vector<cv::Mat>& rgb, int iterations) {
+    using Binarization = rm_auto_aim::Detector::LightParams::Binarization;
+    const bool color_diff = detector.l.binarization == Binarization::ColorDifference;
+
+    StageStats stats({"threshold", "findLights", "matchLights", "classify", "total"});
+    qint64 detections = 0;
+    cv::Mat bin, red, blue;
+    const auto start = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        for (const auto& img : rgb) {
+            const auto t0 = Clock::now();
+            if (color_diff)
+                detector.colorDifference(img, red, blue);
+            else
+                bin = detector.preprocessImage(img);
+            const auto t1     = Clock::now();
+            const auto lights = color_diff ? detector.findLights(img, red, blue)
+                                           : detector.findLights(img, bin);
+            const auto t2     = Clock::now();
+            auto armors       = detector.matchLights(lights);
+            const auto t3     = Clock::now();
+            if (detector.classifier && !armors.empty()) {
+                detector.classifier->extractNumbers(img, armors);
+                detector.classifier->classify(armors);
+            }
+            const auto t4 = Clock::now();
+            detections += qint64(armors.size());
+            stats.add(0, msBetween(t0, t1));
+            stats.add(1, msBetween(t1, t2));
+            stats.add(2, msBetween(t2, t3));
+            stats.add(3, msBetween(t3, t4));
+            stats.add(4, msBetween(t0, t4));
+        }
+    }
+    const double sec = msBetween(start, Clock::now()) / 1000.0;
+
+    QJsonObject o;
+    o["stages"]         = stats.toJson();
+    o["images_per_sec"] = double(rgb.size()) * iterations / sec;
+    o["detections"]     = detections;
+    return o;
+}
+
+QJsonObject benchTraditional(
+    const std::vector<cv::Mat>& images, const QString& assets, int iterations, int bin_thres,
+    int color_diff_thres) {
+    const QString model = assets + "/models/mlp.onnx";
+    const QString label = assets + "/models/label.txt";
+    std::shared_ptr<const rm_auto_aim::NumberClassifier> classifier;
+    if (QFile::exists(model) && QFile::exists(label)) {
+        classifier = std::make_shared<const rm_auto_aim::NumberClassifier>(
+            model.toStdString(), label.toStdString(), 0.8);
+    }
+    const rm_auto_aim::Detector detector(bin_thres, {}, {}, classifier);
+
+    // 传统检测器吃 RGB，转换放在计时之外
+    std::vector<cv::Mat> rgb(images.size());
+    for (size_t i = 0; i < images.size(); ++i)
+        cv::cvtColor(images[i], rgb[i], cv::COLOR_BGR2RGB);
+
+    // 默认灰度二值化的结果放在顶层，色差二值化（LightParams::Binarization）作为对照
+    QJsonObject o     = timeTraditional(detector, rgb, iterations);
+    o["classifier"]   = bool(detector.classifier);
+    o["binary_thres"] = bin_thres;
+
+    rm_auto_aim::Detector::LightParams cd_params;
+    cd_params.binarization     = rm_auto_aim::Detector::LightParams::Binarization::ColorDifference;
+    cd_params.color_diff_thres = color_diff_thres;
+    const rm_auto_aim::Detector cd_detector(bin_thres, cd_params, {}, classifier);
+    QJsonObject cd         = timeTraditional(cd_detector, rgb, iterations);
+    cd["color_diff_thres"] = color_diff_thres;
+    o["color_difference"]  = cd;
+
+    // 同一个 Detector 由多个线程并发 detect（各自的 Result），看整体吞吐
+    const int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    std::atomic<size_t> next{0};
+    const size_t total = rgb.size() * size_t(iterations);
+    const auto pstart  = Clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&] {
+            rm_auto_aim::Detector::Result result;
+            for (size_t k = next++; k < total; k = next++)
+                detector.detect(rgb[k % rgb.size()], result);
+        });
+    for (auto& w : workers)
+        w.join();
+    const double psec = msBetween(pstart, Clock::now()) / 1000.0;
+
+    o["parallel"]    = QJsonObject{{"threads", threads}, {"images_per_sec", double(total) / psec}};
+    o["peak_rss_kb"] = qint64(peakRssKb());
+    return o;
+}
+
+// —— 一致性校验 ——
+
+// 优化前 findLights 的颜色投票：外接矩形内逐像素 pointPolygonTest
+int legacyLightColor(
+    const cv::Mat& rgb, const std::vector<cv::Point>& contour, const cv::Rect& rect) {
+    int sum_r = 0, sum_b = 0;
+    const cv::Mat roi = rgb(rect);
+    for (int i = 0; i < roi.rows; i++)
+        for (int j = 0; j < roi.cols; j++)
+            if (cv::pointPolygonTest(contour, cv::Point2f(j + rect.x, i + rect.y), false) >= 0) {
+                sum_r += roi.at<cv::Vec3b>(i, j)[0];
+                sum_b += roi.at<cv::Vec3b>(i, j)[2];
+            }
+    return sum_r > sum_b ? rm_auto_aim::RED : rm_auto_aim::BLUE;
+}
+
+// 所有 findLights 会投票的轮廓（不只通过 isLight 的），新旧颜色判定逐个对比
+QJsonObject verifyLightColors(const std::vector<cv::Mat>& images, int bin_thres) {
+    rm_auto_aim::Detector detector(bin_thres, {}, {});
+    qint64 contours_checked = 0, mismatches = 0;
+    for (const auto& img : images) {
+        cv::Mat rgb;
+        cv::cvtColor(img, rgb, cv::COLOR_BGR2RGB);
+        std::vector<std::vector<cv::Point>> contours;
+        cv::findContours(
+            detector.preprocessImage(rgb), contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+        for (int i = 0; i < int(contours.size()); ++i) {
+            if (contours[i].size() < 5)
+                continue;
+            const cv::Rect rect = rm_auto_aim::Light(cv::minAreaRect(contours[i])).boundingRect();
+            if ((rect & cv::Rect(0, 0, rgb.cols, rgb.rows)) != rect)
+                continue;
+            ++contours_checked;
+            if (rm_auto_aim::Detector::lightColor(rgb, contours, i, rect)
+                != legacyLightColor(rgb, contours[i], rect))
+                ++mismatches;
+        }
+    }
+    return QJsonObject{{"contours", contours_checked}, {"mismatches", mismatches}};
+}
+
+bool sameArmors(const std::vector<rm_auto_aim::Armor>& a, const std::vector<rm_auto_aim::Armor>& b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (a[i].left_light.center != b[i].left_light.center
+            || a[i].right_light.center != b[i].right_light.center || a[i].type != b[i].type)
+            return false;
+    return true;
+}
+
+// 灯条配对：索引版 matchLights 与原始 O(n^3) 实现的结果（含顺序）逐帧对比；
+// 真实帧灯条少，另加随机密集灯条集（含重复中心）覆盖剪枝边界
+QJsonObject verifyMatchLights(const std::vector<cv::Mat>& images, int bin_thres) {
+    rm_auto_aim::Detector detector(bin_thres, {}, {});
+    std::vector<std::vector<rm_auto_aim::Light>> sets;
+    for (const auto& img : images) {
+        cv::Mat rgb;
+        cv::cvtColor(img, rgb, cv::COLOR_BGR2RGB);
+        sets.push_back(detector.findLights(rgb, detector.preprocessImage(rgb)));
+    }
+    cv::RNG rng(7);
+    for (int s = 0; s < 200; ++s) {
+        const float extent = rng.uniform(100.f, 1000.f);
+        std::vector<rm_auto_aim::Light> lights;
+        for (int n = rng.uniform(2, 200); n > 0; --n) {
+            cv::Point2f c(rng.uniform(0.f, extent), rng.uniform(0.f, extent));
+            if (!lights.empty() && rng.uniform(0, 10) == 0)
+                c = lights.back().center;
+            const cv::Size2f sz(rng.uniform(2.f, 8.f), rng.uniform(10.f, 40.f));
+            lights.emplace_back(cv::RotatedRect(c, sz, rng.uniform(-20.f, 20.f)));
+        }
+        sets.push_back(std::move(lights));
+    }
+    qint64 armors = 0, mismatches = 0;
+    for (const auto& lights : sets) {
+        const auto expected = detector.matchLightsReference(lights);
+        armors += qint64(expected.size());
+        if (!sameArmors(detector.matchLights(lights), expected))
+            ++mismatches;
+    }
+    return QJsonObject{
+        {"light_sets", qint64(sets.size())}, {"armors", armors}, {"mismatches", mismatches}};
+}
+
+// 色差二值化：向量化的 colorDifference 与逐通道饱和相减 + 阈值的参考实现逐像素对比；
+// 另加一张奇数宽度的 ROI 覆盖非连续内存与标量尾部
+QJsonObject verifyColorDifference(const std::vector<cv::Mat>& images, int color_diff_thres) {
+    rm_auto_aim::Detector::LightParams params;
+    params.binarization     = rm_auto_aim::Detector::LightParams::Binarization::ColorDifference;
+    params.color_diff_thres = color_diff_thres;
+    const rm_auto_aim::Detector detector(0, params, {});
+
+    std::vector<cv::Mat> inputs;
+    for (const auto& img : images) {
+        cv::Mat rgb;
+        cv::cvtColor(img, rgb, cv::COLOR_BGR2RGB);
+        inputs.push_back(rgb);
+    }
+    if (!inputs.empty() && inputs.front().cols > 3) {
+        const cv::Mat& first = inputs.front();
+        inputs.push_back(first(cv::Rect(1, 0, (first.cols - 2) | 1, first.rows)));
+    }
+
+    qint64 pixels = 0, mismatches = 0;
+    for (const auto& rgb : inputs) {
+        cv::Mat red, blue;
+        detector.colorDifference(rgb, red, blue);
+        std::vector<cv::Mat> ch;
+        cv::split(rgb, ch);
+        cv::Mat red_ref, blue_ref;
+        cv::subtract(ch[0], ch[2], red_ref); // 8 位饱和
+        cv::subtract(ch[2], ch[0], blue_ref);
+        cv::threshold(red_ref, red_ref, color_diff_thres, 255, cv::THRESH_BINARY);
+        cv::threshold(blue_ref, blue_ref, color_diff_thres, 255, cv::THRESH_BINARY);
+        pixels += qint64(rgb.total());
+        mismatches += cv::countNonZero(red != red_ref) + cv::countNonZero(blue != blue_ref);
+    }
+    return QJsonObject{{"pixels", pixels}, {"mismatches", mismatches}};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ATLabelMaster detector benchmark");
+    parser.addHelpOption();
+    const QCommandLineOption images("images", "Image folder (recursive).", "dir");
+    const QCommandLineOption synthetic(
+        "synthetic", "Use N generated images instead of --images.", "n", "32");
+    const QCommandLineOption size("size", "Synthetic image size WxH.", "size", "1280x1024");
+    const QCommandLineOption seed("seed", "Synthetic generator seed.", "seed", "42");
+    const QCommandLineOption limit("limit", "Max images loaded from --images.", "n", "200");
+    const QCommandLineOption iterations("iterations", "Passes over the image set.", "k", "5");
+    const QCommandLineOption assets("assets", "Assets directory (models/).", "dir", "assets");
+    const QCommandLineOption thres("binary-thres", "Traditional binary threshold.", "t", "100");
+    const QCommandLineOption color_diff_thres(
+        "color-diff-thres", "Traditional R-B / B-R threshold (color difference path).", "t", "60");
+    const QCommandLineOption only("only", "Run only 'ai' or 'traditional'.", "path");
+    const QCommandLineOption out("out", "Write JSON to file instead of stdout.", "file");
+    const QCommandLineOption tile("tile", "AI tiled inference, NxN tiles (0 = off).", "n", "0");
+    const QCommandLineOption tile_overlap("tile-overlap", "Tile overlap in pixels.", "px", "128");
+    const QCommandLineOption tile_batched("tile-batched", "Run all tiles as one batch.");
+    const QCommandLineOption input_size(
+        "input-size", "AI network input size (320 | 416 | 640 | 960).", "px", "640");
+    const QCommandLineOption verify("verify", "Check optimized code paths against the originals.");
+    parser.addOptions(
+        {images, synthetic, size, seed, limit, iterations, assets, thres, color_diff_thres, only,
+         out, tile, tile_overlap, tile_batched, input_size, verify});
+    parser.process(app);
+
+    QJsonObject input;
+    std::vector<cv::Mat> set;
+    if (parser.isSet(images)) {
+        set             = loadImages(parser.value(images), parser.value(limit).toInt());
+        input["source"] = parser.value(images);
+    } else {
+        const QStringList wh = parser.value(size).split('x');
+        const cv::Size sz(wh.value(0).toInt(), wh.value(1).toInt());
+        if (sz.width < 64 || sz.height < 64) {
+            std::fprintf(stderr, "invalid --size\n");
+            return 1;
+        }
+        cv::RNG rng(parser.value(seed).toULongLong());
+        const int n = std::max(1, parser.value(synthetic).toInt());
+        for (int i = 0; i < n; ++i)
+            set.push_back(synthArmorImage(rng, sz));
+        input["source"] = "synthetic";
+        input["seed"]   = parser.value(seed).toLongLong();
+    }
+    if (set.empty()) {
+        std::fprintf(stderr, "no images\n");
+        return 1;
+    }
+    const int iters     = std::max(1, parser.value(iterations).toInt());
+    input["images"]     = qint64(set.size());
+    input["iterations"] = iters;
+    input["width"]      = set.front().cols;
+    input["height"]     = set.front().rows;
+
+    QJsonObject report;
+    report["input"] = input;
+    if (parser.isSet(verify)) {
+        QJsonObject v;
+        v["light_color"]  = verifyLightColors(set, parser.value(thres).toInt());
+        v["match_lights"] = verifyMatchLights(set, parser.value(thres).toInt());
+        v["color_difference"] =
+            verifyColorDifference(set, parser.value(color_diff_thres).toInt());
+        qint64 mismatches = 0;
+        for (const QJsonValue& check : v)
+            mismatches += check.toObject()["mismatches"].toInteger();
+        report["verify"]      = v;
+        const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+        return mismatches == 0 ? 0 : 2;
+    }
+    const QString which = parser.value(only);
+    // 先跑传统路径：峰值 RSS 单调不减，AI 的快照才包含模型占用
+    if (which.isEmpty() || which == "traditional")
+        report["traditional"] = benchTraditional(
+            set, parser.value(assets), iters, parser.value(thres).toInt(),
+            parser.value(color_diff_thres).toInt());
+    if (which.isEmpty() || which == "ai") {
+        ai::Detector::TileParams tiles;
+        tiles.tile    = parser.value(tile).toInt();
+        tiles.enabled = tiles.tile > 0;
+        tiles.overlap = parser.value(tile_overlap).toInt();
+        tiles.batched = parser.isSet(tile_batched);
+        report["ai"]  = benchAi(
+            set, parser.value(assets), iters, tiles, parser.value(input_size).toInt());
+    }
+    report["peak_rss_kb"] = qint64(peakRssKb());
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (parser.isSet(out)) {
+        QFile f(parser.value(out));
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(parser.value(out)));
+            return 1;
+        }
+        f.write(json);
+    } else {
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    }
+    return 0;
+}
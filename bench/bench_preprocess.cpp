@@ -0,0 +1,96 @@
+// 预处理微基准：旧的多遍 OpenCV 路径 vs 融合 kernel（ai::letterboxToPlanar）
+// vs 图内预处理时主机侧只剩的 u8 letterbox（ai::letterboxToHWC）
+// 用法：bench_preprocess [width height iterations]
+#include "detector/ai/preprocess.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+namespace {
+
+constexpr int IN = 640;
+
+// 原 ai::Detector::detect 中的预处理（resize → 贴入 → cvtColor → convertTo → split → memcpy）
+float legacyPreprocess(const cv::Mat& img, float* dst, bool fp32) {
+    const float scale = IN / float(std::max(img.cols, img.rows));
+    cv::Mat resized;
+    cv::resize(
+        img, resized, {int(std::round(img.cols * scale)), int(std::round(img.rows * scale))});
+    cv::Mat input(IN, IN, CV_8UC3, cv::Scalar(127, 127, 127));
+    resized.copyTo(input(cv::Rect(0, 0, resized.cols, resized.rows)));
+    if (fp32)
+        cv::cvtColor(input, input, cv::COLOR_BGR2RGB);
+    cv::Mat f32;
+    input.convertTo(f32, CV_32F, fp32 ? 1.0 / 255.0 : 1.0);
+    std::vector<cv::Mat> ch(3);
+    cv::split(f32, ch);
+    const size_t plane = size_t(IN) * IN;
+    for (int c = 0; c < 3; ++c)
+        std::memcpy(dst + c * plane, ch[c].ptr<float>(), plane * sizeof(float));
+    return scale;
+}
+
+template <class F>
+double medianMs(int iters, F&& f) {
+    std::vector<double> t(iters);
+    for (int i = 0; i < iters; ++i) {
+        const auto t0 = std::chrono::steady_clock::now();
+        f();
+        const auto t1 = std::chrono::steady_clock::now();
+        t[i]          = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    }
+    std::nth_element(t.begin(), t.begin() + iters / 2, t.end());
+    return t[iters / 2];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int w     = argc > 2 ? std::atoi(argv[1]) : 3840;
+    const int h     = argc > 2 ? std::atoi(argv[2]) : 2160;
+    const int iters = argc > 3 ? std::max(1, std::atoi(argv[3])) : 50;
+
+    cv::Mat img(h, w, CV_8UC3);
+    cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(255));
+
+    std::vector<float> a(size_t(3) * IN * IN), b(a.size());
+    for (const bool fp32 : {false, true}) {
+        ai::LetterboxParams p;
+        p.size    = IN;
+        p.swap_rb = fp32;
+        p.scale   = fp32 ? 1.f / 255.f : 1.f;
+
+        // 预热
+        legacyPreprocess(img, a.data(), fp32);
+        ai::letterboxToPlanar(img, b.data(), p);
+
+        const double legacy = medianMs(iters, [&] { legacyPreprocess(img, a.data(), fp32); });
+        const double fused  = medianMs(iters, [&] { ai::letterboxToPlanar(img, b.data(), p); });
+
+        // 旧路径在 8 位上取整，两者相差应在 1 个灰度级以内
+        float max_diff = 0.f;
+        for (size_t i = 0; i < a.size(); ++i)
+            max_diff = std::max(max_diff, std::abs(a[i] - b[i]));
+
+        std::printf(
+            "%s %dx%d: legacy %.3f ms, fused %.3f ms, speedup %.2fx, max |diff| %.4f\n",
+            fp32 ? "FP32" : "INT8", w, h, legacy, fused, legacy / fused,
+            max_diff * (fp32 ? 255.f : 1.f));
+    }
+
+    // u8 NHWC 输入：转换与缩放在模型图内完成，主机只写 1/4 大小的缓冲
+    std::vector<uchar> u8(size_t(3) * IN * IN);
+    ai::LetterboxParams p;
+    p.size = IN;
+    ai::letterboxToHWC(img, u8.data(), p);
+    const double hwc = medianMs(iters, [&] { ai::letterboxToHWC(img, u8.data(), p); });
+    std::printf("u8 HWC %dx%d: %.3f ms\n", w, h, hwc);
+    return 0;
+}
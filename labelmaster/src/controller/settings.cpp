@@ -35,4 +35,18 @@ AppSettings::AppSettings()
     settings_.setFallbacksEnabled(true); // keep default true; set false if you dislike fallbacks
 }
 
+QString AppSettings::modelCacheDir() const {
+    const QString dir = modelCacheDirOverride();
+    if (!dir.isEmpty())
+        return dir;
+    return QDir::homePath() + "/.atlabelmaster/cache/ov";
+}
+
+QString AppSettings::resultCacheDir() const {
+    const QString dir = resultCacheDirOverride();
+    if (!dir.isEmpty())
+        return dir;
+    return QDir::homePath() + "/.atlabelmaster/cache/detections";
+}
+
 } // namespace controller
\ No newline at end of file
@@ -45,11 +45,39 @@ public:
     APP_SETTING_RW_INT (roiH,         Keys::kRoiH,         Def::kRoiH       )
     APP_SETTING_RW_STR (assetsDir,    Keys::kAssetsDir,    Def::kAssetsDir  )
     APP_SETTING_RW_FLOAT (numberClassifierThreshold, Keys::kNumberClassifierThreshold, Def::kNumberClassifierThreshold)
+    APP_SETTING_RW_INT   (binaryThreshold, Keys::kBinaryThreshold, Def::kBinaryThreshold)
+    // AI 与传统检测融合（SmartDetector::Ensemble）
+    APP_SETTING_RW_BOOL  (ensembleMode,    Keys::kEnsembleMode,    Def::kEnsembleMode   )
+    APP_SETTING_RW_FLOAT (nmsIouThreshold, Keys::kNmsIouThreshold, Def::kNmsIouThreshold)
+    APP_SETTING_RW_BOOL  (nmsPolygonIou,   Keys::kNmsPolygonIou,   Def::kNmsPolygonIou  )
+    APP_SETTING_RW_STR   (modelCacheDirOverride, Keys::kModelCacheDir, "")
+    // 性能配置名，见 ai::Detector::Profile；交互标注与离线预标注分开保存
+    APP_SETTING_RW_STR   (performanceProfile, Keys::kPerformanceProfile, Def::kPerformanceProfile)
+    APP_SETTING_RW_STR   (prelabelProfile,    Keys::kPrelabelProfile,    Def::kPrelabelProfile   )
+    // 当前检测模型（ai::ModelInfo::name），空则用默认模型
+    APP_SETTING_RW_STR   (detectorModel,      Keys::kDetectorModel,      ""                      )
+    // 网络输入尺寸档位（网络输入边长，32 的倍数），菜单提供 320 / 416 / 640 / 960
+    APP_SETTING_RW_INT   (inputSize,          Keys::kInputSize,          Def::kInputSize         )
+    // 分块推理（高分辨率相机帧）
+    APP_SETTING_RW_BOOL  (tiledInference, Keys::kTiledInference, Def::kTiledInference)
+    APP_SETTING_RW_INT   (tileSize,       Keys::kTileSize,       Def::kTileSize      )
+    APP_SETTING_RW_INT   (tileOverlap,    Keys::kTileOverlap,    Def::kTileOverlap   )
+    // 打开图片后预先检测的后续张数，0 关闭
+    APP_SETTING_RW_INT   (prefetchCount,  Keys::kPrefetchCount,  Def::kPrefetchCount )
+    // 检测结果持久化缓存（按图片内容 + 模型指纹），上限单位 MB
+    APP_SETTING_RW_BOOL  (resultCacheEnabled,     Keys::kResultCacheEnabled, Def::kResultCacheEnabled)
+    APP_SETTING_RW_INT   (resultCacheMaxMB,       Keys::kResultCacheMaxMB,   Def::kResultCacheMaxMB  )
+    APP_SETTING_RW_STR   (resultCacheDirOverride, Keys::kResultCacheDir,     "")
 
 #undef APP_SETTING_RW_STR
 #undef APP_SETTING_RW_INT
 #undef APP_SETTING_RW_BOOL
 
+    // OpenVINO 编译缓存目录：未配置时为 ~/.atlabelmaster/cache/ov
+    QString modelCacheDir() const;
+    // 检测结果缓存目录：未配置时为 ~/.atlabelmaster/cache/detections（目录归缓存独占）
+    QString resultCacheDir() const;
+
     // 禁止拷贝移动
     AppSettings(const AppSettings&) = delete;
     AppSettings& operator=(const AppSettings&) = delete;
@@ -68,6 +96,22 @@ private:
         static constexpr const char* kRoiH                      = "roi/h";
         static constexpr const char* kAssetsDir                 = "assets/directory";
         static constexpr const char* kNumberClassifierThreshold = "detector/tradition/threshold";
+        static constexpr const char* kBinaryThreshold           = "detector/tradition/binaryThreshold";
+        static constexpr const char* kEnsembleMode              = "detector/ensemble";
+        static constexpr const char* kNmsIouThreshold           = "detector/ai/nmsIou";
+        static constexpr const char* kNmsPolygonIou             = "detector/ai/nmsPolygon";
+        static constexpr const char* kModelCacheDir             = "detector/ai/cacheDir";
+        static constexpr const char* kPerformanceProfile        = "detector/ai/profile";
+        static constexpr const char* kPrelabelProfile           = "detector/ai/prelabelProfile";
+        static constexpr const char* kInputSize                 = "detector/ai/inputSize";
+        static constexpr const char* kDetectorModel             = "detector/ai/model";
+        static constexpr const char* kTiledInference            = "detector/ai/tiled";
+        static constexpr const char* kTileSize                  = "detector/ai/tileSize";
+        static constexpr const char* kTileOverlap               = "detector/ai/tileOverlap";
+        static constexpr const char* kPrefetchCount             = "detector/prefetchCount";
+        static constexpr const char* kResultCacheEnabled        = "detector/resultCache/enabled";
+        static constexpr const char* kResultCacheMaxMB          = "detector/resultCache/maxMB";
+        static constexpr const char* kResultCacheDir            = "detector/resultCache/dir";
     };
     struct Def {
         static constexpr const char* kAssetsDir         = "/home/developer/ws/assets";
@@ -76,6 +120,19 @@ private:
         static constexpr int  kRoiW                     = 640;
         static constexpr int  kRoiH                     = 480;
         static constexpr float  kNumberClassifierThreshold= 80.f;
+        static constexpr int    kBinaryThreshold          = 100;
+        static constexpr bool   kEnsembleMode             = false;
+        static constexpr float  kNmsIouThreshold          = 0.45f;
+        static constexpr bool   kNmsPolygonIou            = false;
+        static constexpr const char* kPerformanceProfile  = "interactive-latency";
+        static constexpr const char* kPrelabelProfile     = "batch-throughput";
+        static constexpr int    kInputSize                = 640;
+        static constexpr bool   kTiledInference           = false;
+        static constexpr int    kTileSize                 = 640;
+        static constexpr int    kTileOverlap              = 128;
+        static constexpr int    kPrefetchCount            = 3;
+        static constexpr bool   kResultCacheEnabled       = true;
+        static constexpr int    kResultCacheMaxMB         = 512;
     };
 
     QSettings settings_;
@@ -0,0 +1,50 @@
+#include "decode.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <opencv2/core/hal/intrin.hpp>
+
+namespace ai {
+
+void filterRows(const float* data, int N, int D, float th, std::vector<int>& rows) {
+    rows.clear();
+    const float* col = data + kColScore;
+    int i            = 0;
+#if CV_SIMD
+    // logit 列步长为 D，用 lut 按行号偏移一次取满一个向量
+    constexpr int VL = cv::v_float32::nlanes;
+    int idx[VL];
+    for (int k = 0; k < VL; ++k)
+        idx[k] = k * D;
+    const cv::v_float32 vth = cv::vx_setall_f32(th);
+    for (; i <= N - VL; i += VL) {
+        const cv::v_float32 v = cv::vx_lut(col + size_t(i) * D, idx);
+        for (unsigned m = unsigned(cv::v_signmask(v >= vth)); m; m &= m - 1)
+            rows.push_back(i + std::countr_zero(m));
+    }
+#endif
+    for (; i < N; ++i)
+        if (col[size_t(i) * D] >= th)
+            rows.push_back(i);
+}
+
+void gatherCandidates(
+    const float* data, int D, const std::vector<int>& rows, float scale,
+    std::vector<Candidate>& out) {
+    out.resize(rows.size());
+    for (size_t k = 0; k < rows.size(); ++k) {
+        const float* r = data + size_t(rows[k]) * D;
+        Candidate& c   = out[k];
+        c.logit        = r[kColScore];
+        c.row          = rows[k];
+        for (int j = 0; j < 8; ++j)
+            c.pts[j] = r[j] / scale;
+        c.xmin = std::min({c.pts[0], c.pts[2], c.pts[4], c.pts[6]});
+        c.xmax = std::max({c.pts[0], c.pts[2], c.pts[4], c.pts[6]});
+        c.ymin = std::min({c.pts[1], c.pts[3], c.pts[5], c.pts[7]});
+        c.ymax = std::max({c.pts[1], c.pts[3], c.pts[5], c.pts[7]});
+    }
+}
+
+} // namespace ai
@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+
+namespace ai {
+
+// 网络输出每行的列布局：0..7 四角点，8 置信度 logit，9..12 颜色，13..21 标签
+constexpr int kColScore = 8;
+constexpr int kColColor = 9;
+constexpr int kColTag   = 13;
+
+// 解码阶段的候选框：POD，放在可复用缓冲里，不含任何字符串
+struct Candidate {
+    float logit;    // 置信度 logit（与 sigmoid 单调一致，排序直接用它）
+    int row;        // 在 [N, D] 输出中的行号，幸存后据此取颜色/标签
+    float pts[8];   // 原图坐标 x0,y0 … x3,y3（TL → BL → BR → TR）
+    float xmin, ymin, xmax, ymax; // 四角点外接矩形
+};
+
+// 扫描 logit 列，把 >= th 的行号写入 rows（先清空）。按 SIMD 宽度成组比较，整组落选时直接跳过
+void filterRows(const float* data, int N, int D, float th, std::vector<int>& rows);
+
+// 取 rows 对应行的角点（除以 scale 还原到原图）并算外接矩形，写入 out（先清空）
+void gatherCandidates(
+    const float* data, int D, const std::vector<int>& rows, float scale,
+    std::vector<Candidate>& out);
+
+} // namespace ai
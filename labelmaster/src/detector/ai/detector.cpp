@@ -0,0 +1,781 @@
+#include "detector.hpp"
+#include "decode.hpp"
+#include "nms.hpp"
+#include "preprocess.hpp"
+#include "runtime.hpp"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace ai {
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double msBetween(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+} // namespace
+
+Detector::Detector()
+    : core_(sharedCore()) {
+    label_map_[0]  = "0";
+    label_map_[1]  = "1";
+    label_map_[2]  = "2";
+    label_map_[3]  = "3";
+    label_map_[4]  = "4";
+    label_map_[5]  = "5";
+    label_map_[6]  = "5";
+    label_map_[7]  = "5";
+    label_map_[8]  = "Bb";
+    label_map_[9]  = "Bs";
+    label_map_[10] = "Bs";
+    label_map_[11] = "Bs";
+    label_map_[12] = "Bs";
+    label_map_[12] = "13";
+}
+
+Detector::~Detector() { waitAll(); }
+
+void Detector::setCacheDir(const QString& dir) {
+    if (dir.isEmpty() || !QDir().mkpath(dir)) {
+        qWarning() << "OpenVINO cache dir unavailable:" << dir;
+        return;
+    }
+    try {
+        core_.set_property(ov::cache_dir(dir.toStdString()));
+    } catch (const std::exception& e) {
+        qWarning() << "OpenVINO cache_dir failed:" << e.what();
+    }
+}
+
+namespace {
+// 依次把各文件内容喂给同一个哈希；任一文件读失败返回空
+QByteArray hashFiles(const QStringList& paths) {
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    for (const QString& p : paths) {
+        QFile f(p);
+        if (!f.open(QIODevice::ReadOnly) || !h.addData(&f))
+            return {};
+    }
+    return h.result();
+}
+} // namespace
+
+void Detector::setupModel(const QString& assets_path) {
+    // 重新加载前先让在途请求跑完
+    waitAll();
+
+    const QString dir = assets_path + "/models/";
+    const QString xml = dir + "model-opt-int8.xml";
+    if (QFile::exists(xml) && loadModel(xml, Mode::OV_INT8_CPU))
+        return;
+    const QString onnx = dir + "model-opt.onnx";
+    if (!QFile::exists(onnx)) {
+        qWarning() << "ONNX model not found:" << onnx;
+        return;
+    }
+    loadModel(onnx, Mode::OV_FP32_CPU);
+}
+
+bool Detector::loadModel(const QString& path, Mode mode) {
+    waitAll();
+    try {
+        model_ = core_.read_model(path.toStdString()); // .xml 自动加载同名 .bin
+        const ov::PartialShape out = model_->output().get_partial_shape();
+        const auto last            = out.rank().is_static() ? out[out.size() - 1]
+                                                            : ov::Dimension::dynamic();
+        if (last.is_static() && last.get_length() < 22)
+            throw std::runtime_error("output is not an armor detector layout");
+
+        QStringList files{path};
+        const QFileInfo fi(path);
+        if (fi.suffix() == "xml")
+            files << fi.path() + '/' + fi.completeBaseName() + ".bin";
+        model_hash_ = hashFiles(files);
+        compile(mode);
+        model_path_ = path;
+        qInfo() << "ai::Detector loaded" << path;
+        return true;
+    } catch (const std::exception& e) {
+        qWarning() << "OpenVINO load" << path << "failed:" << e.what();
+    }
+    std::lock_guard lock(pool_mutex_);
+    model_.reset();
+    size_variants_.clear();
+    compiled_ = {};
+    slots_.clear();
+    free_.clear();
+    model_path_.clear();
+    return false;
+}
+
+// 把预处理嵌入模型图：输入为 u8 NHWC BGR，图内完成 转 f32 / NHWC→NCHW / (FP32) BGR→RGB、/255
+std::shared_ptr<ov::Model> Detector::withPreprocess(
+    const std::shared_ptr<ov::Model>& model, Mode mode) {
+    using namespace ov::preprocess;
+    PrePostProcessor ppp(model->clone());
+    InputInfo& in = ppp.input();
+    in.tensor()
+        .set_element_type(ov::element::u8)
+        .set_layout("NHWC")
+        .set_color_format(ColorFormat::BGR);
+    in.model().set_layout("NCHW");
+    in.preprocess().convert_element_type(ov::element::f32);
+    // INT8 模型图里已带 reverse_input_channels，吃 BGR、[0..255]
+    if (mode == Mode::OV_FP32_CPU)
+        in.preprocess().convert_color(ColorFormat::RGB).scale(255.f);
+    ppp.output().tensor().set_element_type(ov::element::f32);
+    return ppp.build();
+}
+
+ov::CompiledModel Detector::compileVariant(const std::shared_ptr<ov::Model>& model) {
+    try {
+        return core_.compile_model(withPreprocess(model, mode_), "CPU", config_);
+    } catch (const std::exception& e) {
+        // 个别模型无法套 PrePostProcessor 时退回主机侧 float32 预处理
+        qWarning() << "PrePostProcessor failed, fall back to float32 input:" << e.what();
+        return core_.compile_model(model, "CPU", config_);
+    }
+}
+
+QString Detector::profileName(Profile p) {
+    switch (p) {
+    case Profile::BatchThroughput: return "batch-throughput";
+    case Profile::LowPower: return "low-power";
+    case Profile::InteractiveLatency: break;
+    }
+    return "interactive-latency";
+}
+
+Detector::Profile Detector::profileFromName(const QString& name) {
+    for (const Profile p : {Profile::BatchThroughput, Profile::LowPower})
+        if (name == profileName(p))
+            return p;
+    return Profile::InteractiveLatency;
+}
+
+void Detector::setProfile(Profile p) {
+    if (p == profile_)
+        return;
+    profile_ = p;
+    if (!model_)
+        return;
+    waitAll();
+    try {
+        compile(mode_);
+    } catch (const std::exception& e) {
+        qWarning() << "OpenVINO recompile for profile" << profileName(p) << "failed:" << e.what();
+    }
+}
+
+ov::AnyMap Detector::compileConfig() {
+    std::vector<ov::PropertyName> supported;
+    std::vector<std::string> caps;
+    try {
+        supported = core_.get_property("CPU", ov::supported_properties);
+        caps      = core_.get_property("CPU", ov::device::capabilities);
+    } catch (const std::exception& e) {
+        qWarning() << "OpenVINO CPU properties unavailable:" << e.what();
+    }
+    ov::AnyMap cfg;
+    // 旧版本插件不认识的属性直接跳过，避免整次编译失败
+    auto put = [&](std::pair<std::string, ov::Any> prop) {
+        if (std::find(supported.begin(), supported.end(), prop.first) != supported.end())
+            cfg.insert(std::move(prop));
+    };
+    auto has_cap = [&](const char* c) {
+        return std::find(caps.begin(), caps.end(), c) != caps.end();
+    };
+
+    using ov::hint::PerformanceMode;
+    switch (profile_) {
+    case Profile::InteractiveLatency:
+        put(ov::hint::performance_mode(PerformanceMode::LATENCY));
+        put(ov::num_streams(1));
+        put(ov::hint::enable_cpu_pinning(true));
+        break;
+    case Profile::BatchThroughput:
+        put(ov::hint::performance_mode(PerformanceMode::THROUGHPUT));
+        put(ov::num_streams(ov::streams::AUTO));
+        put(ov::hint::enable_cpu_pinning(true));
+        if (has_cap(ov::device::capability::BF16))
+            put(ov::hint::inference_precision(ov::element::bf16));
+        else if (has_cap(ov::device::capability::FP16))
+            put(ov::hint::inference_precision(ov::element::f16));
+        break;
+    case Profile::LowPower:
+        put(ov::hint::performance_mode(PerformanceMode::LATENCY));
+        put(ov::num_streams(1));
+        put(ov::inference_num_threads(std::max(1, int(std::thread::hardware_concurrency()) / 4)));
+        put(ov::hint::enable_cpu_pinning(false));
+        break;
+    }
+    return cfg;
+}
+
+void Detector::logEffectiveConfig() const {
+    auto prop = [](auto&& read) -> QString {
+        try {
+            return read();
+        } catch (const std::exception&) {
+            return "n/a";
+        }
+    };
+    const QString streams =
+        prop([this] { return QString::number(compiled_.get_property(ov::num_streams).num); });
+    const QString threads =
+        prop([this] { return QString::number(compiled_.get_property(ov::inference_num_threads)); });
+    const QString precision = prop([this] {
+        return QString::fromStdString(
+            compiled_.get_property(ov::hint::inference_precision).get_type_name());
+    });
+    qInfo().noquote() << "ai::Detector profile" << profileName(profile_) << "streams:" << streams
+                      << "threads:" << threads << "precision:" << precision;
+}
+
+void Detector::compile(Mode mode) {
+    mode_   = mode;
+    config_ = compileConfig();
+    size_variants_.clear();
+    try {
+        activateInputSize(input_size_);
+    } catch (const std::exception& e) {
+        // 个别导出的模型不能 reshape，退回模型自身的输入尺寸
+        qWarning() << "input size" << input_size_ << "unavailable, using native:" << e.what();
+        const ov::PartialShape s = model_->input().get_partial_shape();
+        const bool fixed = s.rank().is_static() && s.size() == 4 && s[3].is_static();
+        input_size_      = fixed ? int(s[3].get_length()) : kDefaultInputSize;
+        activateInputSize(input_size_);
+    }
+    logEffectiveConfig();
+}
+
+bool Detector::setInputSize(int size) {
+    if (size < 32 || size % 32 != 0) {
+        qWarning() << "ai::Detector input size must be a multiple of 32:" << size;
+        return false;
+    }
+    if (size == input_size_ && (compiled_ || !model_))
+        return true;
+    if (!model_) {
+        input_size_ = size;
+        return true;
+    }
+    waitAll();
+    try {
+        activateInputSize(size);
+    } catch (const std::exception& e) {
+        qWarning() << "ai::Detector reshape to" << size << "failed:" << e.what();
+        return false;
+    }
+    input_size_ = size;
+    return true;
+}
+
+void Detector::activateInputSize(int size) {
+    auto it = size_variants_.find(size);
+    if (it == size_variants_.end()) {
+        // 模型输入为 NCHW（图内预处理之前），只改 H、W
+        auto model         = model_->clone();
+        ov::PartialShape s = model->input().get_partial_shape();
+        s[2]               = size;
+        s[3]               = size;
+        model->reshape(s);
+        it = size_variants_.emplace(size, SizeVariant{model, compileVariant(model)}).first;
+        qInfo() << "ai::Detector compiled input size" << size;
+    }
+    compiled_ = it->second.compiled;
+    buildPool();
+
+    std::lock_guard lock(batch_mutex_);
+    batch_compiled_ = 0;
+    batch_failed_   = 0;
+    batch_model_    = {};
+    batch_request_  = {};
+}
+
+// —— 请求池 ——
+void Detector::buildPool() {
+    uint32_t n = 1;
+    try {
+        n = compiled_.get_property(ov::optimal_number_of_infer_requests);
+    } catch (const std::exception& e) {
+        qWarning() << "optimal_number_of_infer_requests unavailable:" << e.what();
+    }
+    n = std::max<uint32_t>(n, 1);
+
+    std::lock_guard lock(pool_mutex_);
+    slots_.clear();
+    free_.clear();
+    slots_.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        slots_[i].request = compiled_.create_infer_request();
+        // 回调只捕获下标，避免 request 持有自身形成环
+        slots_[i].request.set_callback([this, i](std::exception_ptr ex) {
+            Slot& s = slots_[i];
+            QVector<Armor> results;
+            if (ex) {
+                try {
+                    std::rethrow_exception(ex);
+                } catch (const std::exception& e) {
+                    qWarning() << "OpenVINO async infer failed:" << e.what();
+                }
+            } else {
+                results = decode(s.request.get_output_tensor(), s.scale);
+            }
+            // 先归还请求再回调，回调里可以直接投递下一帧
+            Callback done = std::move(s.done);
+            release(int(i));
+            if (done)
+                done(std::move(results));
+            // 持锁通知：waitAll 返回后析构可能立刻发生，解锁后不能再访问成员
+            std::lock_guard lock(pool_mutex_);
+            --callbacks_;
+            pool_cv_.notify_all();
+        });
+        free_.push_back(int(i));
+    }
+    qInfo() << "ai::Detector infer request pool size:" << n;
+}
+
+int Detector::acquire() {
+    std::unique_lock lock(pool_mutex_);
+    pool_cv_.wait(lock, [this] { return !free_.empty(); });
+    const int slot = free_.back();
+    free_.pop_back();
+    return slot;
+}
+
+void Detector::release(int slot) {
+    {
+        std::lock_guard lock(pool_mutex_);
+        free_.push_back(slot);
+    }
+    pool_cv_.notify_all();
+}
+
+void Detector::waitAll() {
+    std::unique_lock lock(pool_mutex_);
+    pool_cv_.wait(lock, [this] { return free_.size() == slots_.size() && callbacks_ == 0; });
+}
+
+// —— 检测 ——
+QVector<Armor> Detector::detect(const cv::Mat& img, StageTimes* times, PixelOrder order) {
+    if (!compiled_) {
+        qWarning() << "SmartDetector not initialized.";
+        return {};
+    }
+    if (const TileParams tp = tileParams();
+        tp.enabled && std::max(img.cols, img.rows) > tp.tile)
+        return detectTiled(img, order);
+
+    const int id = acquire();
+    Slot& s      = slots_[id];
+    QVector<Armor> results;
+    try {
+        const auto t0 = Clock::now();
+        s.scale       = preprocess(img, order, s.request.get_input_tensor());
+        const auto t1 = Clock::now();
+        s.request.infer();
+        const auto t2 = Clock::now();
+        results       = decode(s.request.get_output_tensor(), s.scale, times);
+        if (times) {
+            times->preprocess = msBetween(t0, t1);
+            times->infer      = msBetween(t1, t2);
+        }
+    } catch (...) {
+        release(id);
+        throw;
+    }
+    release(id);
+    return results;
+}
+
+void Detector::detectAsync(const cv::Mat& img, Callback done, PixelOrder order) {
+    if (!compiled_) {
+        qWarning() << "SmartDetector not initialized.";
+        if (done)
+            done({});
+        return;
+    }
+
+    const int id = acquire();
+    Slot& s      = slots_[id];
+    try {
+        s.scale = preprocess(img, order, s.request.get_input_tensor());
+        s.done  = std::move(done);
+        {
+            std::lock_guard lock(pool_mutex_);
+            ++callbacks_;
+        }
+        s.request.start_async();
+    } catch (...) {
+        s.done = nullptr;
+        {
+            std::lock_guard lock(pool_mutex_);
+            callbacks_ = std::max(0, callbacks_ - 1);
+        }
+        release(id);
+        throw;
+    }
+}
+
+std::future<QVector<Armor>> Detector::detectAsync(const cv::Mat& img, PixelOrder order) {
+    auto promise = std::make_shared<std::promise<QVector<Armor>>>();
+    auto future  = promise->get_future();
+    detectAsync(img, [promise](QVector<Armor> r) { promise->set_value(std::move(r)); }, order);
+    return future;
+}
+
+// —— 分块 ——
+namespace {
+// 一个轴上的块起点：步长 tile - overlap，最后一块贴齐图像边缘
+std::vector<int> tileStarts(int len, int tile, int overlap) {
+    std::vector<int> starts{0};
+    if (len <= tile)
+        return starts;
+    const int step = tile - overlap;
+    for (int s = step; s + tile < len; s += step)
+        starts.push_back(s);
+    starts.push_back(len - tile);
+    return starts;
+}
+} // namespace
+
+QVector<Armor> Detector::detectTiled(const cv::Mat& img, PixelOrder order) {
+    if (!compiled_ || img.empty())
+        return {};
+    const TileParams tp = tileParams();
+    std::vector<cv::Rect> tiles;
+    for (const int y : tileStarts(img.rows, tp.tile, tp.overlap))
+        for (const int x : tileStarts(img.cols, tp.tile, tp.overlap))
+            tiles.emplace_back(
+                x, y, std::min(tp.tile, img.cols - x), std::min(tp.tile, img.rows - y));
+
+    // 块都是原图的 ROI 视图，预处理直接从原图内存读取，不拷贝
+    std::vector<QVector<Armor>> per_tile(tiles.size());
+    if (tp.batched) {
+        std::vector<cv::Mat> views;
+        views.reserve(tiles.size());
+        for (const auto& r : tiles)
+            views.push_back(img(r));
+        auto res = detectBatch(views, order);
+        for (size_t i = 0; i < tiles.size(); ++i)
+            per_tile[i] = std::move(res[qsizetype(i)]);
+    } else {
+        std::vector<std::future<QVector<Armor>>> futures;
+        futures.reserve(tiles.size());
+        for (const auto& r : tiles)
+            futures.push_back(detectAsync(img(r), order));
+        for (size_t i = 0; i < futures.size(); ++i)
+            per_tile[i] = futures[i].get();
+    }
+
+    // 平移回原图坐标并收集成候选。贴着块内侧边缘的框多半是被截断的半块：整个落在另一块内部
+    // （离那块的内侧边缘也有 kEdge 以上）时那块里有完整的一份，这里直接丢掉，免得和完整框
+    // IoU 不够而双份保留。否则保留，两块各自截断的目标不会两边都丢
+    constexpr float kEdge = 4.f;
+    // 框是否贴着块 r 的内侧边缘（图像边缘不算）
+    auto touchesEdge = [&](const cv::Rect& r, const Candidate& c) {
+        return (r.x > 0 && c.xmin < r.x + kEdge)
+            || (r.x + r.width < img.cols && c.xmax > r.x + r.width - kEdge)
+            || (r.y > 0 && c.ymin < r.y + kEdge)
+            || (r.y + r.height < img.rows && c.ymax > r.y + r.height - kEdge);
+    };
+    // 框整个在块 r 里，且不贴它的内侧边缘
+    auto inside = [&](const cv::Rect& r, const Candidate& c) {
+        return c.xmin >= r.x && c.xmax <= r.x + r.width && c.ymin >= r.y
+            && c.ymax <= r.y + r.height && !touchesEdge(r, c);
+    };
+    QVector<Armor> all;
+    std::vector<Candidate> cand;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        const cv::Rect& r = tiles[i];
+        const QPointF off(r.x, r.y);
+        for (Armor a : per_tile[i]) {
+            a.p0 += off;
+            a.p1 += off;
+            a.p2 += off;
+            a.p3 += off;
+            Candidate c;
+            c.logit = a.score; // 只用于排序，sigmoid 单调，直接用 score
+            c.row   = int(all.size());
+            const QPointF p[4] = {a.p0, a.p1, a.p2, a.p3};
+            for (int k = 0; k < 4; ++k) {
+                c.pts[2 * k]     = float(p[k].x());
+                c.pts[2 * k + 1] = float(p[k].y());
+            }
+            c.xmin = std::min({c.pts[0], c.pts[2], c.pts[4], c.pts[6]});
+            c.xmax = std::max({c.pts[0], c.pts[2], c.pts[4], c.pts[6]});
+            c.ymin = std::min({c.pts[1], c.pts[3], c.pts[5], c.pts[7]});
+            c.ymax = std::max({c.pts[1], c.pts[3], c.pts[5], c.pts[7]});
+
+            if (touchesEdge(r, c)
+                && std::any_of(tiles.begin(), tiles.end(), [&](const cv::Rect& t) {
+                       return t != r && inside(t, c);
+                   }))
+                continue;
+            cand.push_back(c);
+            all.push_back(std::move(a));
+        }
+    }
+
+    // 跨块 NMS：重叠区里同一目标的多份结果只留置信度最高的一份
+    std::sort(cand.begin(), cand.end(), [](const Candidate& A, const Candidate& B) {
+        return A.logit > B.logit;
+    });
+    Nms nms;
+    std::vector<int> keep;
+    nms.run(cand, nmsParams(), keep);
+
+    QVector<Armor> results;
+    results.reserve(qsizetype(keep.size()));
+    for (const int k : keep)
+        results.push_back(std::move(all[cand[k].row]));
+    return results;
+}
+
+// —— 批量 ——
+void Detector::setBatchSize(int n) {
+    std::lock_guard lock(batch_mutex_);
+    batch_size_ = std::max(1, n);
+}
+
+bool Detector::ensureBatchEngine() {
+    if (batch_compiled_ == batch_size_)
+        return true;
+    if (batch_failed_ == batch_size_)
+        return false;
+    try {
+        auto model         = size_variants_.at(input_size_).model->clone();
+        ov::PartialShape s = model->input().get_partial_shape();
+        s[0]               = batch_size_;
+        model->reshape(s);
+        batch_model_    = compileVariant(model);
+        batch_request_  = batch_model_.create_infer_request();
+        batch_compiled_ = batch_size_;
+        qInfo() << "ai::Detector batch model compiled, batch =" << batch_size_;
+        return true;
+    } catch (const std::exception& e) {
+        qWarning() << "reshape to batch" << batch_size_ << "failed:" << e.what();
+        batch_failed_ = batch_size_;
+        return false;
+    }
+}
+
+QVector<QVector<Armor>> Detector::detectBatch(std::span<const cv::Mat> images, PixelOrder order) {
+    QVector<QVector<Armor>> results(qsizetype(images.size()));
+    if (!compiled_) {
+        qWarning() << "SmartDetector not initialized.";
+        return results;
+    }
+
+    std::unique_lock lock(batch_mutex_);
+    if (!ensureBatchEngine()) {
+        lock.unlock();
+        std::vector<std::future<QVector<Armor>>> futures;
+        futures.reserve(images.size());
+        for (const auto& img : images)
+            futures.push_back(detectAsync(img, order));
+        for (size_t i = 0; i < futures.size(); ++i)
+            results[qsizetype(i)] = futures[i].get();
+        return results;
+    }
+
+    const int B         = batch_compiled_;
+    const ov::Tensor in = batch_request_.get_input_tensor();
+    std::vector<float> sc(B, 1.f);
+    for (size_t first = 0; first < images.size(); first += B) {
+        // 不足一整块时尾部沿用上一块的数据，结果直接丢弃
+        const int n = int(std::min<size_t>(B, images.size() - first));
+        cv::parallel_for_(cv::Range(0, n), [&](const cv::Range& r) {
+            for (int i = r.start; i < r.end; ++i)
+                sc[i] = preprocess(images[first + i], order, in, size_t(i));
+        });
+        batch_request_.infer();
+
+        const ov::Tensor out = batch_request_.get_output_tensor();
+        int ob = 0, N = 0, D = 0;
+        if (!outputLayout(out, ob, N, D))
+            break;
+        const float* data = out.data<float>();
+        for (int i = 0; i < std::min(n, ob); ++i)
+            results[qsizetype(first + i)] = decode(data + size_t(i) * N * D, N, D, sc[i]);
+    }
+    return results;
+}
+
+// —— 1) 预处理（与 SmartModel 一致：左上角贴入、灰底=127；边长取自 tensor，即当前输入尺寸）——
+// u8 输入：只做 letterbox，直接写进 Tensor 内存，其余交给模型图（图内吃 BGR）；
+// 退回 float32 时：INT8 BGR、[0..255]，FP32 RGB、/255，融合 kernel 一遍写入 NCHW Tensor。
+// 输入顺序与目标顺序不同时在同一遍里交换 R/B，不单独 cvtColor
+float Detector::preprocess(
+    const cv::Mat& img, PixelOrder order, const ov::Tensor& tensor, size_t index) const {
+    const bool u8       = tensor.get_element_type() == ov::element::u8;
+    const ov::Shape shp = tensor.get_shape(); // u8：[B, S, S, 3]；f32：[B, 3, S, S]
+    const int IN        = int(u8 ? shp[1] : shp[2]);
+    const size_t sz     = size_t(3) * IN * IN; // 单张图的元素数（HWC 与 CHW 相同）
+    const bool rgb_in   = order == PixelOrder::RGB;
+    LetterboxParams p;
+    p.size = IN;
+    p.pad  = 127;
+    if (u8) {
+        p.swap_rb = rgb_in;
+        return letterboxToHWC(img, tensor.data<uint8_t>() + index * sz, p);
+    }
+    p.swap_rb = (mode_ == Mode::OV_FP32_CPU) != rgb_in;
+    p.scale   = mode_ == Mode::OV_FP32_CPU ? 1.f / 255.f : 1.f;
+    return letterboxToPlanar(img, tensor.data<float>() + index * sz, p);
+}
+
+bool Detector::outputLayout(const ov::Tensor& out, int& B, int& N, int& D) {
+    const auto shp = out.get_shape();
+    if (shp.size() == 3) {
+        B = int(shp[0]);
+        N = int(shp[1]);
+        D = int(shp[2]);
+    } else if (shp.size() == 2) {
+        B = 1;
+        N = int(shp[0]);
+        D = int(shp[1]);
+    } else {
+        qWarning() << "Unexpected output shape rank:" << int(shp.size());
+        return false;
+    }
+    if (D < 22) {
+        qWarning() << "Output D too small:" << D;
+        return false;
+    }
+    return true;
+}
+
+QVector<Armor> Detector::decode(const ov::Tensor& out, float scale, StageTimes* times) const {
+    int B = 0, N = 0, D = 0;
+    if (!outputLayout(out, B, N, D))
+        return {};
+    return decode(out.data<float>(), N, D, scale, times);
+}
+
+// —— 4) 解析单张图的 [N, D] 输出 ——
+// 先用 SIMD 在 logit 列上筛行，幸存行写进 POD 候选缓冲（每线程复用），
+// NMS 之后才为留下的框构造带字符串的 Armor
+QVector<Armor> Detector::decode(
+    const float* data, int N, int D, float scale, StageTimes* times) const {
+    static const QString kColors[4] = {"B", "R", "G", "P"};
+    auto sigmoid                    = [](float x) { return 1.f / (1.f + std::exp(-x)); };
+    auto inv_sigmoid                = [](float x) { return -std::log(1 / x - 1); };
+    const float th                  = inv_sigmoid(0.5f);
+
+    thread_local std::vector<int> rows;
+    thread_local std::vector<Candidate> cand;
+    thread_local std::vector<int> keep;
+
+    // —— 5) 筛选 + 收集候选（四角点：原图坐标 = /scale；左上贴入，无偏移）——
+    const auto t0 = Clock::now();
+    filterRows(data, N, D, th, rows);
+    gatherCandidates(data, D, rows, scale, cand);
+
+    // —— 6) NMS：按置信度降序贪心抑制，x 方向排序扫描，大部分框对不会被测试 ——
+    const auto t1 = Clock::now();
+    std::sort(cand.begin(), cand.end(), [](const Candidate& A, const Candidate& B) {
+        return A.logit > B.logit;
+    });
+    thread_local Nms nms;
+    nms.run(cand, nmsParams(), keep);
+    const auto t2 = Clock::now();
+
+    // —— 7) 只为幸存者构造 Armor ——
+    QVector<Armor> results;
+    results.reserve(qsizetype(keep.size()));
+    for (const int k : keep) {
+        const Candidate& c = cand[k];
+        const float* r     = data + size_t(c.row) * D;
+        Armor a;
+        a.score = sigmoid(c.logit); // 置信度
+        a.p0    = QPointF(c.pts[0], c.pts[1]);
+        a.p1    = QPointF(c.pts[2], c.pts[3]);
+        a.p2    = QPointF(c.pts[4], c.pts[5]);
+        a.p3    = QPointF(c.pts[6], c.pts[7]);
+        // 颜色 4 类 & 标签 9 类
+        a.color = kColors[argmax(r + kColColor, 4)];
+        a.cls   = label_map_.value(argmax(r + kColTag, 9));
+        results.push_back(std::move(a));
+    }
+    if (times) {
+        times->decode = msBetween(t0, t1) + msBetween(t2, Clock::now());
+        times->nms    = msBetween(t1, t2);
+    }
+    return results;
+}
+
+int Detector::argmax(const float* p, int len) {
+    int k = 0;
+    for (int i = 1; i < len; ++i)
+        if (p[i] > p[k])
+            k = i;
+    return k;
+}
+
+void Detector::setNmsParams(const NmsParams& p) {
+    std::lock_guard lk(params_mutex_);
+    nms_ = p;
+}
+
+NmsParams Detector::nmsParams() const {
+    std::lock_guard lk(params_mutex_);
+    return nms_;
+}
+
+QByteArray Detector::fingerprint() const {
+    const NmsParams nms    = nmsParams();
+    const TileParams tiles = tileParams();
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    h.addData(model_hash_);
+    // 实际生效的推理精度：BatchThroughput 会选 bf16 / f16，结果与 f32 不完全相同
+    QString precision = "n/a";
+    if (compiled_) {
+        try {
+            precision = QString::fromStdString(
+                compiled_.get_property(ov::hint::inference_precision).get_type_name());
+        } catch (const std::exception&) {
+            // 设备不支持查询时按 n/a 计
+        }
+    }
+    // 解码常量（灰底 127、置信度 0.5）写死在代码里，改动时递增 v1
+    const QString params =
+        QString("v1|mode=%1|in=%2|nms=%3,%4|tile=%5,%6,%7|prec=%8")
+            .arg(int(mode_))
+            .arg(input_size_)
+            .arg(double(nms.iou_threshold))
+            .arg(int(nms.polygon_iou))
+            .arg(int(tiles.enabled))
+            .arg(tiles.tile)
+            .arg(tiles.overlap)
+            .arg(precision);
+    h.addData(params.toUtf8());
+    return h.result().toHex();
+}
+
+void Detector::setTileParams(const TileParams& p) {
+    std::lock_guard lk(params_mutex_);
+    tiles_         = p;
+    tiles_.tile    = std::max(32, p.tile);
+    tiles_.overlap = std::clamp(p.overlap, 0, tiles_.tile / 2);
+}
+
+Detector::TileParams Detector::tileParams() const {
+    std::lock_guard lk(params_mutex_);
+    return tiles_;
+}
+
+} // namespace ai
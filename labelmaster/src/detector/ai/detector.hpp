@@ -1,203 +1,186 @@
 #pragma once
-#include <QDebug>
-#include <QFile>
-#include <QVector>
 #include <QHash>
-#include <algorithm>
-#include <cmath>
-#include <cstring>
-#include <opencv2/imgproc.hpp>
+#include <QString>
+#include <QVector>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <span>
+#include <opencv2/core.hpp>
+#include <openvino/core/preprocess/pre_post_process.hpp>
 #include <openvino/openvino.hpp>
 #include <types.hpp>                                             // Armor 定义
+#include <vector>
+
+#include "nms.hpp"
+#include "preprocess.hpp"
 
 namespace ai {
 
-struct Detector {
-    Detector() = default;
+// 基于 OpenVINO 的装甲板检测器。
+// 内部维护一个 InferRequest 池（大小取自 optimal_number_of_infer_requests），
+// detect() 为同步接口，detectAsync() 在调用线程完成预处理后立即返回，
+// 推理结束后在 OpenVINO 的回调线程中解码并回调，因此第 N+1 帧的预处理可以和第 N 帧的推理重叠。
+// 所有公开接口均可多线程调用；池中请求全部在途时 detect/detectAsync 会阻塞等待空闲请求。
+// detectBatch() 使用单独编译的 batch 模型（输入 [B, 640, 640, 3]），一次推理处理 B 张图，适合离线预标注。
+class Detector {
+public:
+    using Callback = std::function<void(QVector<Armor>)>;
 
     enum class Mode { OV_INT8_CPU, OV_FP32_CPU };
 
-    void setupModel(const QString& assets_path) {
-        label_map_[0] = "0";
-        label_map_[1] = "1";
-        label_map_[2] = "2";
-        label_map_[3] = "3";
-        label_map_[4] = "4";
-        label_map_[5] = "5";
-        label_map_[6] = "5";
-        label_map_[7] = "5";
-        label_map_[8] = "Bb";
-        label_map_[9] = "Bs";
-        label_map_[10] = "Bs";
-        label_map_[11] = "Bs";
-        label_map_[12] = "Bs";
-        label_map_[12] = "13";
-
-        const QString dir = assets_path + "/models/";
-        try {
-            const QString xml = dir + "model-opt-int8.xml";
-            if (QFile::exists(xml)) {
-                model_    = core_.read_model(xml.toStdString()); // 自动加载同名 .bin
-                compiled_ = core_.compile_model(model_, "CPU");
-                request_  = compiled_.create_infer_request();
-                mode_     = Mode::OV_INT8_CPU;
-                return;
-            }
-        } catch (const std::exception& e) {
-            qWarning() << "OpenVINO INT8 failed:" << e.what();
-        }
-        try {
-            const QString onnx = dir + "model-opt.onnx";
-            if (!QFile::exists(onnx)) {
-                qWarning() << "ONNX model not found:" << onnx;
-                return;
-            }
-            model_    = core_.read_model(onnx.toStdString());
-            compiled_ = core_.compile_model(model_, "CPU");
-            request_  = compiled_.create_infer_request();
-            mode_     = Mode::OV_FP32_CPU;
-        } catch (const std::exception& e) {
-            qWarning() << "OpenVINO FP32 failed:" << e.what();
-        }
-    }
-
-    QVector<Armor> detect(cv::Mat& img) {
-        QVector<Armor> results;
-        if (!compiled_) {
-            qWarning() << "SmartDetector not initialized.";
-            return results;
-        }
-
-        // —— 1) 预处理（与 SmartModel 一致：640、左上角贴入、灰底=127）——
-        constexpr int IN  = 640;
-        const float scale = IN / float(std::max(img.cols, img.rows));
-        cv::Mat resized;
-        cv::resize(
-            img, resized, {int(std::round(img.cols * scale)), int(std::round(img.rows * scale))});
-        cv::Mat input(IN, IN, CV_8UC3, cv::Scalar(127, 127, 127));
-        resized.copyTo(input(cv::Rect(0, 0, resized.cols, resized.rows)));
-
-        // INT8：BGR、[0..255]；FP32：RGB、/255
-        if (mode_ == Mode::OV_FP32_CPU)
-            cv::cvtColor(input, input, cv::COLOR_BGR2RGB);
-
-        // —— 2) 打包 NCHW float32 Tensor（INT8 也走 float32 但不 /255）——
-        cv::Mat f32;
-        const double sf = (mode_ == Mode::OV_INT8_CPU) ? 1.0 : (1.0 / 255.0);
-        input.convertTo(f32, CV_32F, sf);
-        ov::Tensor in_tensor(ov::element::f32, {1, 3, IN, IN});
-        {
-            std::vector<cv::Mat> ch(3);
-            cv::split(f32, ch);
-            float* dst         = in_tensor.data<float>();
-            const size_t plane = size_t(IN) * IN;
-            std::memcpy(dst + 0 * plane, ch[0].ptr<float>(), plane * sizeof(float));
-            std::memcpy(dst + 1 * plane, ch[1].ptr<float>(), plane * sizeof(float));
-            std::memcpy(dst + 2 * plane, ch[2].ptr<float>(), plane * sizeof(float));
-        }
-
-        // —— 3) 推理 ——
-        request_.set_input_tensor(in_tensor);
-        request_.infer();
-
-        // —— 4) 读取输出（假设 [1, N, D]，兼容 {N,D}）——
-        ov::Tensor out    = request_.get_output_tensor();
-        const auto shp    = out.get_shape();
-        const float* data = out.data<float>();
-        int N = 0, D = 0;
-        if (shp.size() == 3) {
-            N = int(shp[1]);
-            D = int(shp[2]);
-        } else if (shp.size() == 2) {
-            N = int(shp[0]);
-            D = int(shp[1]);
-        } else {
-            qWarning() << "Unexpected output shape rank:" << int(shp.size());
-            return results;
-        }
-        if (D < 22) {
-            qWarning() << "Output D too small:" << D;
-            return results;
-        }
-
-        auto sigmoid     = [](float x) { return 1.f / (1.f + std::exp(-x)); };
-        auto inv_sigmoid = [](float x) { return -std::log(1 / x - 1); };
-        const float th   = inv_sigmoid(0.5f);
-
-        // —— 5) 解析行，与 SmartModel 完全一致 ——
-        QVector<Armor> cand;
-        cand.reserve(N);
-        for (int i = 0; i < N; ++i) {
-            const float* r = data + i * D;
-            if (r[8] < th)
-                continue;            // logit 阈值
-            Armor a;
-            a.score = sigmoid(r[8]); // 置信度
-
-            // 四角点（原图坐标 = /scale；左上贴入，无偏移）
-            a.p0 = QPointF(r[0] / scale, r[1] / scale);
-            a.p1 = QPointF(r[2] / scale, r[3] / scale);
-            a.p2 = QPointF(r[4] / scale, r[5] / scale);
-            a.p3 = QPointF(r[6] / scale, r[7] / scale);
-
-            // 颜色 4 类 & 标签 9 类
-            const int color_id = argmax(r + 9, 4);
-            const int tag_id   = argmax(r + 13, 9);
-            a.color =
-                (color_id == 0   ? "B"
-                 : color_id == 1 ? "R"
-                 : color_id == 2 ? "G"
-                                 : "P");
-            a.cls = label_map_[tag_id];
-
-            cand.push_back(a);
-        }
-
-        // —— 6) NMS：按四角点外接矩形重叠即抑制（thres=0 等价）——
-        std::sort(cand.begin(), cand.end(), [](const Armor& A, const Armor& B) {
-            return A.score > B.score;
-        });
-        std::vector<char> removed(cand.size(), 0);
-        for (int i = 0; i < cand.size(); ++i) {
-            if (removed[i])
-                continue;
-            results.push_back(cand[i]);
-            for (int j = i + 1; j < cand.size(); ++j) {
-                if (removed[j])
-                    continue;
-                if (isOverlap(cand[i], cand[j]))
-                    removed[j] = 1;
-            }
-        }
-        return results;
-    }
+    // 性能配置：编译模型时套用的一组 OpenVINO 属性（性能 hint / streams / 线程 / 绑核 / 推理精度）
+    // interactive-latency：单流、绑核，单张延迟最低，交互标注用
+    // batch-throughput：多流、bf16/f16（CPU 支持时），吞吐最高，离线预标注用
+    // low-power：单流、约 1/4 核心、不绑核，后台运行时少占机器
+    enum class Profile { InteractiveLatency, BatchThroughput, LowPower };
+
+    // 分块推理：大图切成相互重叠的 tile×tile 块，各块按原分辨率检测，角点平移回原图后跨块 NMS。
+    // 远处装甲板在整图缩到 640 时只剩几个像素，分块后不再被缩小
+    struct TileParams {
+        bool enabled = false;
+        int tile     = 640;   // 块边长（原图像素），每块再按网络输入等比缩放
+        int overlap  = 128;   // 相邻块重叠像素，应大于最大目标尺寸
+        bool batched = false; // true：所有块走 detectBatch 一次推理；false：请求池并行异步
+    };
+    // 默认输入尺寸（网络输入边长）。小尺寸如 320 适合近处大目标的快速预标注，960 才看得清远处目标；
+    // 模型按尺寸 reshape 后编译，letterbox 缩放与角点还原都随输入尺寸变化
+    static constexpr int kDefaultInputSize = 640;
+
+    static QString profileName(Profile p);
+    static Profile profileFromName(const QString& name); // 未知名称退回 InteractiveLatency
+
+    // 同步检测各阶段耗时（毫秒），供 bench_detector 使用
+    struct StageTimes {
+        double preprocess = 0;
+        double infer      = 0;
+        double decode     = 0; // 筛行 + 收集候选 + 构造 Armor，不含 NMS
+        double nms        = 0; // 排序 + NMS
+    };
+
+    Detector();
+    ~Detector();
+
+    Detector(const Detector&)            = delete;
+    Detector& operator=(const Detector&) = delete;
+
+    // 启用 OpenVINO 编译缓存（ov::cache_dir），需在 setupModel 之前调用。
+    // 命中缓存时跳过图优化与编译，热启动只剩读模型和加载缓存 blob
+    void setCacheDir(const QString& dir);
+    // 重新加载模型前会等待在途请求，但不能与 detect 并发调用
+    // 默认模型：<assets>/models/model-opt-int8.xml，失败时退回 model-opt.onnx
+    void setupModel(const QString& assets_path);
+    // 加载指定模型文件（.xml 自动带上同名 .bin）。输出不是 [N, >=22] 的模型视为非检测模型，拒绝加载。
+    // 失败时检测器回到未就绪状态并返回 false；同样不能与 detect 并发调用
+    bool loadModel(const QString& path, Mode mode);
+    bool ready() const { return bool(compiled_); }
+    QString modelPath() const { return model_path_; }
+    Mode mode() const { return mode_; }
+    // 结果指纹（hex）：模型文件内容 + 影响输出的参数（输入尺寸、置信度阈值、NMS、分块、
+    // 实际推理精度）。持久化的检测结果按它区分，模型文件或参数一变旧结果即失效；
+    // 性能配置的流数、线程数不影响结果，不计入
+    QByteArray fingerprint() const;
+    // 模型已加载时立即按新配置重新编译（先等待在途请求），不能与 detect 并发调用
+    void setProfile(Profile p);
+    Profile profile() const { return profile_; }
+    // 切换输入尺寸（32 的倍数）。各尺寸的编译结果按当前 profile 缓存，切回编译过的档位只需重建请求池；
+    // 模型未加载时只记下尺寸。先等待在途请求，不能与 detect 并发调用；reshape 失败时保持原档位并返回 false
+    bool setInputSize(int size);
+    int inputSize() const { return input_size_; }
+    int poolSize() const { return int(slots_.size()); }
+
+    // 输入图均为 CV_8UC3 / CV_8UC4，order 给出前三个通道的顺序；预处理直接从 img 读取，
+    // 按模型需要的顺序写入 Tensor，调用方不必事先转换或拷贝（QImage 见 util/bridge.hpp 的 qimageView）
+
+    // 同步检测（阻塞到结果返回）；times 非空时填入各阶段耗时。
+    // 启用分块且图像任一边超过块边长时转到 detectTiled（此时不填 times）
+    QVector<Armor> detect(
+        const cv::Mat& img, StageTimes* times = nullptr, PixelOrder order = PixelOrder::BGR);
+    QVector<Armor> detectTiled(const cv::Mat& img, PixelOrder order = PixelOrder::BGR);
+    // 异步检测：done 在 OpenVINO 回调线程中调用
+    void detectAsync(const cv::Mat& img, Callback done, PixelOrder order = PixelOrder::BGR);
+    std::future<QVector<Armor>> detectAsync(
+        const cv::Mat& img, PixelOrder order = PixelOrder::BGR);
+    // 批量检测：按 batchSize() 分块，每块一次推理；返回值与 images 一一对应。
+    // 模型无法 reshape 到该 batch 时退回请求池逐张异步推理
+    QVector<QVector<Armor>> detectBatch(
+        std::span<const cv::Mat> images, PixelOrder order = PixelOrder::BGR);
+    void setBatchSize(int n);
+    int batchSize() const { return batch_size_; }
+    // NMS 参数，可随时修改，对之后解码的结果生效
+    void setNmsParams(const NmsParams& p);
+    NmsParams nmsParams() const;
+    void setTileParams(const TileParams& p);
+    TileParams tileParams() const;
+    // 等待所有在途请求完成
+    void waitAll();
 
 private:
+    struct Slot {
+        ov::InferRequest request;
+        float scale = 1.f; // 原图 → 网络输入的缩放
+        Callback done;
+    };
+
+    static std::shared_ptr<ov::Model> withPreprocess(
+        const std::shared_ptr<ov::Model>& model, Mode mode);
+    ov::CompiledModel compileVariant(const std::shared_ptr<ov::Model>& model);
+    ov::AnyMap compileConfig();      // 按 profile_ 生成，只保留 CPU 插件支持的属性
+    void logEffectiveConfig() const; // 打印编译后实际生效的 streams / 线程 / 精度
+    void compile(Mode mode);
+    void activateInputSize(int size); // 取缓存或 reshape + 编译，替换 compiled_ 并重建请求池
+    void buildPool();
+    int acquire();
+    void release(int slot);
+    bool ensureBatchEngine(); // 调用方持有 batch_mutex_
+
+    // 把 img 写入 tensor 的第 index 张；按 tensor 元素类型区分 u8（图内预处理）/ f32。返回缩放
+    float preprocess(
+        const cv::Mat& img, PixelOrder order, const ov::Tensor& tensor, size_t index = 0) const;
+    // 输出视为 [B, N, D]（兼容 [N, D]）
+    static bool outputLayout(const ov::Tensor& out, int& B, int& N, int& D);
+    QVector<Armor> decode(
+        const float* data, int N, int D, float scale, StageTimes* times = nullptr) const;
+    QVector<Armor> decode(const ov::Tensor& out, float scale, StageTimes* times = nullptr) const;
+
+    static int argmax(const float* p, int len);
+
     Mode mode_{Mode::OV_FP32_CPU};
-    ov::Core core_;
+    Profile profile_{Profile::InteractiveLatency};
+    ov::Core& core_;    // ai::sharedCore()，缓存目录等 Core 属性对全进程生效
+    ov::AnyMap config_; // 当前 profile 的编译属性，batch 模型同样使用
     std::shared_ptr<ov::Model> model_;
+    QByteArray model_hash_; // 已加载模型文件（.xml + .bin 或 .onnx）的 SHA-1
+    QString model_path_;
     ov::CompiledModel compiled_;
-    ov::InferRequest request_;
+    int input_size_ = kDefaultInputSize;
+    // 已编译的各输入尺寸：reshape 后的模型（batch 模型从它派生）与编译结果；换模型或 profile 时清空
+    struct SizeVariant {
+        std::shared_ptr<ov::Model> model;
+        ov::CompiledModel compiled;
+    };
+    std::map<int, SizeVariant> size_variants_;
     QHash<int, QString> label_map_;
-
-    static int argmax(const float* p, int len) {
-        int k = 0;
-        for (int i = 1; i < len; ++i)
-            if (p[i] > p[k])
-                k = i;
-        return k;
-    }
-
-    static bool isOverlap(const Armor& a, const Armor& b) {
-        auto rect = [](const Armor& s) {
-            const float xmin = std::min({s.p0.x(), s.p1.x(), s.p2.x(), s.p3.x()});
-            const float xmax = std::max({s.p0.x(), s.p1.x(), s.p2.x(), s.p3.x()});
-            const float ymin = std::min({s.p0.y(), s.p1.y(), s.p2.y(), s.p3.y()});
-            const float ymax = std::max({s.p0.y(), s.p1.y(), s.p2.y(), s.p3.y()});
-            return cv::Rect2f(xmin, ymin, xmax - xmin, ymax - ymin);
-        };
-        return (rect(a) & rect(b)).area() > 0;
-    }
+    NmsParams nms_;
+    TileParams tiles_;
+    mutable std::mutex params_mutex_; // 保护 nms_ / tiles_，decode 在 OpenVINO 回调线程中读取
+
+    // 请求池（pool_mutex_ 保护 free_ / callbacks_）
+    std::vector<Slot> slots_;
+    std::vector<int> free_;
+    int callbacks_ = 0; // 已 start_async 但回调尚未执行完的请求数
+    std::mutex pool_mutex_;
+    std::condition_variable pool_cv_;
+
+    // batch 模型（batch_mutex_ 保护），按需编译
+    std::mutex batch_mutex_;
+    int batch_size_     = 4;
+    int batch_compiled_ = 0; // 已编译的 batch，0 表示未编译
+    int batch_failed_   = 0; // reshape 失败过的 batch，避免反复尝试
+    ov::CompiledModel batch_model_;
+    ov::InferRequest batch_request_;
 };
 
 } // namespace ai
@@ -0,0 +1,52 @@
+#include "model_registry.hpp"
+
+#include <QDir>
+#include <QFileInfo>
+
+namespace ai {
+
+ModelRegistry::ModelRegistry(const QString& assets_path)
+    : dir_(assets_path + "/models") {
+    rescan();
+}
+
+void ModelRegistry::rescan() {
+    models_.clear();
+    const QDir dir(dir_);
+    for (const QFileInfo& fi : dir.entryInfoList({"*.xml", "*.onnx"}, QDir::Files, QDir::Name)) {
+        if (fi.suffix() == "onnx" && fi.completeBaseName().startsWith("mlp"))
+            continue;
+        ModelInfo m;
+        m.name = fi.fileName();
+        m.path = fi.absoluteFilePath();
+        if (fi.suffix() == "xml") {
+            if (!dir.exists(fi.completeBaseName() + ".bin"))
+                continue;
+            m.mode = Detector::Mode::OV_INT8_CPU;
+        }
+        models_.push_back(m);
+    }
+}
+
+QStringList ModelRegistry::names() const {
+    QStringList out;
+    for (const ModelInfo& m : models_)
+        out << m.name;
+    return out;
+}
+
+const ModelInfo* ModelRegistry::find(const QString& name) const {
+    for (const ModelInfo& m : models_)
+        if (m.name == name)
+            return &m;
+    return nullptr;
+}
+
+const ModelInfo* ModelRegistry::defaultModel() const {
+    for (const char* name : {"model-opt-int8.xml", "model-opt.onnx"})
+        if (const ModelInfo* m = find(name))
+            return m;
+    return models_.isEmpty() ? nullptr : &models_.front();
+}
+
+} // namespace ai
@@ -0,0 +1,39 @@
+#pragma once
+#include "detector.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace ai {
+
+// 可供 ai::Detector 加载的一个模型文件
+struct ModelInfo {
+    QString name; // 文件名（含扩展名），界面与设置里用它指代模型
+    QString path; // 绝对路径
+    // .xml（OpenVINO IR，量化导出时已带 reverse_input_channels）按 INT8 处理：吃 BGR、[0..255]；
+    // .onnx 按 FP32 处理：吃 RGB、/255
+    Detector::Mode mode = Detector::Mode::OV_FP32_CPU;
+};
+
+// 扫描 <assets>/models/ 下的检测模型：带同名 .bin 的 .xml 与 .onnx，按文件名排序。
+// 数字分类器（mlp*.onnx）由传统检测器使用，不列出；其余非检测模型在 Detector::loadModel 时被拒绝
+class ModelRegistry {
+public:
+    ModelRegistry() = default;
+    explicit ModelRegistry(const QString& assets_path);
+
+    void rescan();
+    const QVector<ModelInfo>& models() const { return models_; }
+    QStringList names() const;
+    // 按名称查找，找不到返回 nullptr
+    const ModelInfo* find(const QString& name) const;
+    // 与 Detector::setupModel 相同的默认选择：model-opt-int8.xml，其次 model-opt.onnx，再次第一个
+    const ModelInfo* defaultModel() const;
+
+private:
+    QString dir_;
+    QVector<ModelInfo> models_;
+};
+
+} // namespace ai
@@ -0,0 +1,81 @@
+#include "nms.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <opencv2/imgproc.hpp>
+
+namespace ai {
+
+void Nms::run(const std::vector<Candidate>& cand, const NmsParams& p, std::vector<int>& keep) {
+    keep.clear();
+    const int n = int(cand.size());
+    if (n == 0)
+        return;
+
+    xmin_.resize(n);
+    ymin_.resize(n);
+    xmax_.resize(n);
+    ymax_.resize(n);
+    area_.resize(n);
+    float max_w = 0.f;
+    for (int i = 0; i < n; ++i) {
+        xmin_[i] = cand[i].xmin;
+        ymin_[i] = cand[i].ymin;
+        xmax_[i] = cand[i].xmax;
+        ymax_[i] = cand[i].ymax;
+        area_[i] = (xmax_[i] - xmin_[i]) * (ymax_[i] - ymin_[i]);
+        max_w    = std::max(max_w, xmax_[i] - xmin_[i]);
+    }
+
+    by_x_.resize(n);
+    std::iota(by_x_.begin(), by_x_.end(), 0);
+    std::sort(by_x_.begin(), by_x_.end(), [this](int a, int b) { return xmin_[a] < xmin_[b]; });
+    sorted_x_.resize(n);
+    for (int k = 0; k < n; ++k)
+        sorted_x_[k] = xmin_[by_x_[k]];
+
+    if (p.polygon_iou) {
+        hulls_.resize(n);
+        poly_area_.resize(n);
+        for (int i = 0; i < n; ++i) {
+            const float* q            = cand[i].pts;
+            const cv::Point2f quad[4] = {{q[0], q[1]}, {q[2], q[3]}, {q[4], q[5]}, {q[6], q[7]}};
+            // 凸包统一顶点方向，也顺带处理网络偶尔输出的自交四边形
+            cv::convexHull(std::vector<cv::Point2f>(quad, quad + 4), hulls_[i]);
+            poly_area_[i] = float(cv::contourArea(hulls_[i]));
+        }
+    }
+
+    removed_.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        if (removed_[i])
+            continue;
+        keep.push_back(i);
+        // xmin <= xmin_i - max_w 的框 xmax <= xmin_i，不可能有正面积交叠
+        const auto lo = std::lower_bound(sorted_x_.begin(), sorted_x_.end(), xmin_[i] - max_w);
+        const auto hi = std::lower_bound(lo, sorted_x_.end(), xmax_[i]);
+        for (auto it = lo; it != hi; ++it) {
+            const int j = by_x_[size_t(it - sorted_x_.begin())];
+            if (j > i && !removed_[j] && suppress(i, j, p))
+                removed_[j] = 1;
+        }
+    }
+}
+
+bool Nms::suppress(int i, int j, const NmsParams& p) {
+    const float iw = std::min(xmax_[i], xmax_[j]) - std::max(xmin_[i], xmin_[j]);
+    const float ih = std::min(ymax_[i], ymax_[j]) - std::max(ymin_[i], ymin_[j]);
+    if (iw <= 0.f || ih <= 0.f)
+        return false;
+
+    float inter = iw * ih;
+    float uni   = area_[i] + area_[j] - inter;
+    if (p.polygon_iou) {
+        inter = cv::intersectConvexConvex(hulls_[i], hulls_[j], inter_, true);
+        uni   = poly_area_[i] + poly_area_[j] - inter;
+    }
+    // IoU > t  ⇔  inter > t · union（避免除法，t = 0 时即 inter > 0）
+    return inter > 0.f && inter > p.iou_threshold * uni;
+}
+
+} // namespace ai
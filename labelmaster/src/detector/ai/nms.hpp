@@ -0,0 +1,40 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <vector>
+
+#include "decode.hpp"
+
+namespace ai {
+
+struct NmsParams {
+    // IoU 严格大于阈值即抑制；0 等价于旧规则“外接矩形有重叠即抑制”
+    float iou_threshold = 0.45f;
+    // true：在四边形上算真实 IoU（外接矩形仍用于粗筛）
+    bool polygon_iou = false;
+};
+
+// 面向四边形候选的贪心 NMS。
+// 外接矩形一次性展开成 SoA；按 xmin 排序后，对每个保留框只二分出 x 方向可能相交的区间
+// （xmin ∈ (xmin_i - 最大宽度, xmax_i)），区间外的框根本不做测试。
+// 实例内的缓冲会复用，单个实例不可并发使用（decode 中按线程各持一个）。
+class Nms {
+public:
+    // cand 需已按置信度降序排列；keep 输出保留的下标（同样是降序）
+    void run(const std::vector<Candidate>& cand, const NmsParams& p, std::vector<int>& keep);
+
+private:
+    bool suppress(int i, int j, const NmsParams& p);
+
+    // struct-of-arrays
+    std::vector<float> xmin_, ymin_, xmax_, ymax_, area_;
+    std::vector<int> by_x_;       // 按 xmin 升序的下标
+    std::vector<float> sorted_x_; // xmin_[by_x_[k]]，用于二分
+    std::vector<char> removed_;
+
+    // 多边形 IoU
+    std::vector<std::vector<cv::Point2f>> hulls_;
+    std::vector<float> poly_area_;
+    std::vector<cv::Point2f> inter_;
+};
+
+} // namespace ai
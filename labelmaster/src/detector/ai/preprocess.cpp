@@ -0,0 +1,166 @@
+#include "preprocess.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+namespace ai {
+
+namespace {
+
+// 水平方向的插值表（与 cv::resize INTER_LINEAR 相同的像素中心映射）
+struct XTab {
+    int ofs0, ofs1; // 左右两个源像素的字节偏移
+    float a;        // 右侧权重
+};
+
+// 把一行源像素水平插值成 3 个 float 平面（每平面 width 个）
+inline void hresize(const uchar* row, const XTab* xt, int width, float* out) {
+    float* o0 = out;
+    float* o1 = out + width;
+    float* o2 = out + 2 * width;
+    for (int x = 0; x < width; ++x) {
+        const uchar* p0 = row + xt[x].ofs0;
+        const uchar* p1 = row + xt[x].ofs1;
+        const float a   = xt[x].a;
+        o0[x]           = p0[0] + a * float(p1[0] - p0[0]);
+        o1[x]           = p0[1] + a * float(p1[1] - p0[1]);
+        o2[x]           = p0[2] + a * float(p1[2] - p0[2]);
+    }
+}
+
+// d = (h0 * w0 + h1 * w1)，权重已乘上像素缩放
+inline void vblend(const float* h0, const float* h1, float w0, float w1, int n, float* d) {
+    int x = 0;
+#if CV_SIMD
+    const int VL          = cv::v_float32::nlanes;
+    const cv::v_float32 a = cv::vx_setall_f32(w0);
+    const cv::v_float32 b = cv::vx_setall_f32(w1);
+    const cv::v_float32 z = cv::vx_setzero_f32();
+    for (; x <= n - VL; x += VL) {
+        const cv::v_float32 v0 = cv::vx_load(h0 + x);
+        const cv::v_float32 v1 = cv::vx_load(h1 + x);
+        cv::v_store(d + x, cv::v_muladd(v1, b, cv::v_muladd(v0, a, z)));
+    }
+#endif
+    for (; x < n; ++x)
+        d[x] = h0[x] * w0 + h1[x] * w1;
+}
+
+} // namespace
+
+float letterboxToPlanar(const cv::Mat& src, float* dst, const LetterboxParams& p) {
+    CV_Assert((src.type() == CV_8UC3 || src.type() == CV_8UC4) && !src.empty() && dst);
+
+    const int S       = p.size;
+    const float scale = S / float(std::max(src.cols, src.rows));
+    const int out_w   = std::clamp(int(std::round(src.cols * scale)), 1, S);
+    const int out_h   = std::clamp(int(std::round(src.rows * scale)), 1, S);
+    // cv::resize 按实际输出尺寸求每个轴的比例
+    const double fx = double(src.cols) / out_w;
+    const double fy = double(src.rows) / out_h;
+
+    // 每线程复用的缓冲：x 表 + 两行水平插值结果（各 3 个平面）
+    thread_local std::vector<XTab> xtab;
+    thread_local std::vector<float> rows;
+    const int cn = src.channels();
+    xtab.resize(out_w);
+    rows.resize(size_t(6) * out_w);
+
+    for (int x = 0; x < out_w; ++x) {
+        const double sx = (x + 0.5) * fx - 0.5;
+        int x0          = int(std::floor(sx));
+        float a         = float(sx - x0);
+        if (x0 < 0) {
+            x0 = 0;
+            a  = 0.f;
+        }
+        int x1 = x0 + 1;
+        if (x1 >= src.cols) {
+            x0 = x1 = src.cols - 1;
+            a       = 0.f;
+        }
+        xtab[x] = {x0 * cn, x1 * cn, a};
+    }
+
+    const size_t plane = size_t(S) * S;
+    float* planes[3]   = {dst, dst + plane, dst + 2 * plane};
+    if (p.swap_rb)
+        std::swap(planes[0], planes[2]);
+
+    // 两个行缓冲按源行号缓存，放大时相邻输出行可复用。
+    // 输出行对应的源行单调不减，淘汰行号较小的缓冲即可保证 y0 不被 y1 挤掉
+    float* buf[2]  = {rows.data(), rows.data() + 3 * out_w};
+    int buf_row[2] = {-1, -1};
+    auto hrow      = [&](int sy) -> const float* {
+        for (int i = 0; i < 2; ++i)
+            if (buf_row[i] == sy)
+                return buf[i];
+        const int k = buf_row[0] <= buf_row[1] ? 0 : 1;
+        hresize(src.ptr<uchar>(sy), xtab.data(), out_w, buf[k]);
+        buf_row[k] = sy;
+        return buf[k];
+    };
+
+    const float padv = p.pad * p.scale;
+    for (int y = 0; y < out_h; ++y) {
+        const double sy = (y + 0.5) * fy - 0.5;
+        int y0          = int(std::floor(sy));
+        float b         = float(sy - y0);
+        if (y0 < 0) {
+            y0 = 0;
+            b  = 0.f;
+        }
+        int y1 = y0 + 1;
+        if (y1 >= src.rows) {
+            y0 = y1 = src.rows - 1;
+            b       = 0.f;
+        }
+        const float* r0 = hrow(y0);
+        const float* r1 = hrow(y1);
+
+        const float w0 = (1.f - b) * p.scale;
+        const float w1 = b * p.scale;
+        for (int c = 0; c < 3; ++c) {
+            float* d = planes[c] + size_t(y) * S;
+            vblend(r0 + c * out_w, r1 + c * out_w, w0, w1, out_w, d);
+            std::fill(d + out_w, d + S, padv);
+        }
+    }
+    // 底部填充
+    for (int c = 0; c < 3; ++c)
+        std::fill(planes[c] + size_t(out_h) * S, planes[c] + plane, padv);
+
+    return scale;
+}
+
+float letterboxToHWC(const cv::Mat& src, uchar* dst, const LetterboxParams& p) {
+    CV_Assert((src.type() == CV_8UC3 || src.type() == CV_8UC4) && !src.empty() && dst);
+
+    const int S       = p.size;
+    const float scale = S / float(std::max(src.cols, src.rows));
+    const int out_w   = std::clamp(int(std::round(src.cols * scale)), 1, S);
+    const int out_h   = std::clamp(int(std::round(src.rows * scale)), 1, S);
+
+    // 直接包装外部内存，resize 的目标 ROI 尺寸/类型一致时不会重新分配
+    cv::Mat canvas(S, S, CV_8UC3, dst);
+    cv::Mat roi = canvas(cv::Rect(0, 0, out_w, out_h));
+    if (src.type() == CV_8UC3 && !p.swap_rb) {
+        cv::resize(src, roi, roi.size());
+    } else {
+        // 先在源通道数下缩放（输出远小于原图），再一遍挑出/重排前三个通道写进画布
+        thread_local cv::Mat small;
+        cv::resize(src, small, roi.size());
+        const int from_to[] = {0, p.swap_rb ? 2 : 0, 1, 1, 2, p.swap_rb ? 0 : 2};
+        cv::mixChannels(&small, 1, &roi, 1, from_to, 3);
+    }
+    if (out_w < S)
+        canvas(cv::Rect(out_w, 0, S - out_w, out_h)).setTo(cv::Scalar::all(p.pad));
+    if (out_h < S)
+        canvas(cv::Rect(0, out_h, S, S - out_h)).setTo(cv::Scalar::all(p.pad));
+    return scale;
+}
+
+} // namespace ai
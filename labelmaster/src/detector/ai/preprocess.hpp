@@ -0,0 +1,29 @@
+#pragma once
+#include <opencv2/core.hpp>
+
+namespace ai {
+
+// 输入图前三个通道的顺序（4 通道时第 4 个通道忽略）
+enum class PixelOrder { BGR, RGB };
+
+// letterbox 参数：等比缩放到 size×size，左上角贴入，其余填 pad
+struct LetterboxParams {
+    int size     = 640;
+    uchar pad    = 127;
+    bool swap_rb = false; // true：输出通道顺序与输入相反（BGR ↔ RGB）
+    float scale  = 1.f;   // 像素值乘数（FP32 模型为 1/255）
+};
+
+// 融合的单遍预处理：双线性缩放 + 填充 + 通道交换 + 缩放 + HWC→CHW，
+// 直接写入 dst（3 个连续的 size×size float 平面，通常就是 ov::Tensor 的内存）。
+// 插值与 cv::resize(INTER_LINEAR) 同样采用像素中心对齐，但不经过 8 位量化。
+// src 为 CV_8UC3 或 CV_8UC4（只取前三个通道，可直接读 QImage 的 32 位像素）。
+// 返回 原图 → 网络输入 的缩放系数。
+float letterboxToPlanar(const cv::Mat& src, float* dst, const LetterboxParams& p);
+
+// u8 版本：只做缩放 + 填充，直接写入 dst（size×size×3 的 HWC u8 缓冲，即 u8 NHWC Tensor 的内存）。
+// 布局转换与缩放由模型图内的 PrePostProcessor 完成，这里忽略 scale；
+// swap_rb 仍然生效，用于 RGB 输入喂给吃 BGR 的模型图。src 要求同上。
+float letterboxToHWC(const cv::Mat& src, uchar* dst, const LetterboxParams& p);
+
+} // namespace ai
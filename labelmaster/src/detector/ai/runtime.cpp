@@ -0,0 +1,11 @@
+#include "runtime.hpp"
+
+namespace ai {
+
+ov::Core& sharedCore() {
+    // 首次使用时构造（加载插件较慢），静态局部变量保证线程安全的一次初始化
+    static ov::Core core;
+    return core;
+}
+
+} // namespace ai
@@ -0,0 +1,11 @@
+#pragma once
+#include <openvino/openvino.hpp>
+
+namespace ai {
+
+// 进程内唯一的 ov::Core。ai::Detector 与 NumberClassifier 的 OpenVINO 后端都从这里编译，
+// 共用同一个 CPU 插件实例及其线程池 / streams 执行器，避免两套运行时争抢核心。
+// ov::Core 的 read_model / compile_model / set_property 可并发调用
+ov::Core& sharedCore();
+
+} // namespace ai
@@ -0,0 +1,119 @@
+#include "ensemble.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace ensemble {
+
+namespace {
+QPointF toPoint(const cv::Point2f& p) { return QPointF(p.x, p.y); }
+
+QRectF boundingRect(const ::Armor& a) {
+    const qreal xmin = std::min({a.p0.x(), a.p1.x(), a.p2.x(), a.p3.x()});
+    const qreal xmax = std::max({a.p0.x(), a.p1.x(), a.p2.x(), a.p3.x()});
+    const qreal ymin = std::min({a.p0.y(), a.p1.y(), a.p2.y(), a.p3.y()});
+    const qreal ymax = std::max({a.p0.y(), a.p1.y(), a.p2.y(), a.p3.y()});
+    return QRectF(QPointF(xmin, ymin), QPointF(xmax, ymax));
+}
+
+qreal iou(const QRectF& a, const QRectF& b) {
+    const QRectF inter = a.intersected(b);
+    if (inter.isEmpty())
+        return 0;
+    const qreal i = inter.width() * inter.height();
+    return i / (a.width() * a.height() + b.width() * b.height() - i);
+}
+} // namespace
+
+bool toArmor(const rm_auto_aim::Armor& in, float min_number_conf, ::Armor& out) {
+    if (in.confidence < min_number_conf)
+        return false;
+    const std::string& n = in.number;
+    if (n.size() == 1 && n[0] >= '1' && n[0] <= '5')
+        out.cls = QString::fromStdString(n);
+    else if (n == "O" || n == "G")
+        out.cls = QString::fromStdString(n);
+    else if (n == "B")
+        out.cls = in.type == rm_auto_aim::ArmorType::LARGE ? "Bb" : "Bs";
+    else
+        return false; // negative / 未知
+
+    out.color = in.left_light.color == rm_auto_aim::RED ? "R" : "B";
+    out.score = in.confidence;
+    out.p0    = toPoint(in.left_light.top);
+    out.p1    = toPoint(in.left_light.bottom);
+    out.p2    = toPoint(in.right_light.bottom);
+    out.p3    = toPoint(in.right_light.top);
+    return true;
+}
+
+QVector<::Armor> fuse(
+    const QVector<::Armor>& ai, const QVector<::Armor>& traditional, const FuseParams& p) {
+    // 两路得分不同尺度（AI 是 logit 的 sigmoid，传统是数字分类的 softmax），不混在一起排序，
+    // 各自按得分降序
+    auto byScore = [](const QVector<::Armor>& v) {
+        std::vector<int> order(v.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return v[a].score > v[b].score;
+        });
+        return order;
+    };
+    auto rectsOf = [](const QVector<::Armor>& v) {
+        std::vector<QRectF> rects(v.size());
+        for (int i = 0; i < int(v.size()); ++i)
+            rects[i] = boundingRect(v[i]);
+        return rects;
+    };
+    const std::vector<int> ai_order    = byScore(ai);
+    const std::vector<int> tr_order    = byScore(traditional);
+    const std::vector<QRectF> ai_rects = rectsOf(ai);
+    const std::vector<QRectF> tr_rects = rectsOf(traditional);
+    std::vector<char> ai_taken(ai.size(), 0);
+    std::vector<char> tr_taken(traditional.size(), 0);
+
+    // 把 order 中尚未归簇、与 lead 重叠的成员收进簇，返回其中得分最高的一个（没有时为 -1）
+    auto absorb = [&](const QRectF& lead, const std::vector<int>& order,
+                      const std::vector<QRectF>& rects, std::vector<char>& taken) {
+        int best = -1;
+        for (const int j : order) {
+            if (taken[j] || iou(lead, rects[j]) <= p.iou_threshold)
+                continue;
+            taken[j] = 1;
+            if (best < 0)
+                best = j;
+        }
+        return best;
+    };
+
+    QVector<::Armor> out;
+    // AI 结果领簇：类别、颜色、得分保持 AI 的，簇内有传统结果时只换上它的灯条角点
+    for (const int lead : ai_order) {
+        if (ai_taken[lead])
+            continue;
+        ai_taken[lead] = 1;
+        absorb(ai_rects[lead], ai_order, ai_rects, ai_taken);
+        ::Armor a       = ai[lead];
+        const int match = absorb(ai_rects[lead], tr_order, tr_rects, tr_taken);
+        if (match >= 0) {
+            const ::Armor& t = traditional[match];
+            a.p0             = t.p0;
+            a.p1             = t.p1;
+            a.p2             = t.p2;
+            a.p3             = t.p3;
+        }
+        out.push_back(std::move(a));
+    }
+    // AI 没检出的目标：传统结果自己按得分聚类
+    for (const int lead : tr_order) {
+        if (tr_taken[lead])
+            continue;
+        tr_taken[lead] = 1;
+        absorb(tr_rects[lead], tr_order, tr_rects, tr_taken);
+        out.push_back(traditional[lead]);
+    }
+    return out;
+}
+
+} // namespace ensemble
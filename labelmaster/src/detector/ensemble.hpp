@@ -0,0 +1,27 @@
+#pragma once
+#include "detector/armor.hpp" // rm_auto_aim::Armor
+#include "types.hpp"          // ::Armor
+
+#include <QRectF>
+#include <QVector>
+
+// AI 与传统检测器的结果融合（SmartDetector 的 Ensemble 模式）
+namespace ensemble {
+
+struct FuseParams {
+    float iou_threshold   = 0.45f; // 两个框视为同一目标的 IoU（四角点外接矩形）
+    float min_number_conf = 0.8f;  // 传统路径数字分类置信度下限，低于它的结果丢弃
+};
+
+// 灯条对 → 四角点（TL → BL → BR → TR）：左灯条上端、左灯条下端、右灯条下端、右灯条上端。
+// 颜色取左灯条的颜色；类别按 label.txt（1..5 / O / G / B / negative）映射成标注用的名称，
+// B 按装甲大小分成 Bb / Bs。negative、未知类别或置信度不足时返回 false
+bool toArmor(const rm_auto_aim::Armor& in, float min_number_conf, ::Armor& out);
+
+// 融合：两路得分尺度不同，不放在一起比。AI 结果按得分降序贪心聚类（同 NMS），
+// 每簇的类别、颜色、得分保持 AI 的；簇内有传统结果时角点换成其中得分最高的那个，
+// 灯条端点通常比网络回归的角点更准。没有 AI 结果覆盖的传统结果单独聚类后原样输出
+QVector<::Armor> fuse(
+    const QVector<::Armor>& ai, const QVector<::Armor>& traditional, const FuseParams& p);
+
+} // namespace ensemble
@@ -2,10 +2,22 @@
 #include "controller/settings.hpp"
 #include "util/bridge.hpp"
 
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
 #include <QMetaType>
+#include <QMutexLocker>
 #include <QtGlobal>
+#include <algorithm>
+#include <future>
 #include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 #include <qglobal.h>
@@ -18,77 +30,608 @@ SmartDetector::SmartDetector(
     QObject* parent)
     : QObject(parent) {
     qRegisterMetaType<std::vector<rm_auto_aim::Armor>>("std::vector<rm_auto_aim::Armor>");
-    traditional_detector_ = std::make_unique<Detector>(bin_thres, lp, ap);
+    traditional_detector_ = std::make_shared<const Detector>(bin_thres, lp, ap);
     mode                  = Mode::Traditional;
+    setupThresholdTimer();
 }
 
 SmartDetector::SmartDetector(QObject* parent)
     : QObject(parent) {
-    ai_detector_ = std::make_unique<ai::Detector>();
-    ai_detector_->setupModel(controller::AppSettings::instance().assetsDir());
     mode = Mode::AI;
+    setupThresholdTimer();
+}
+
+void SmartDetector::setupThresholdTimer() {
+    threshold_timer_.setSingleShot(true);
+    threshold_timer_.setInterval(kThresholdDebounceMs);
+    connect(&threshold_timer_, &QTimer::timeout, this, &SmartDetector::applyBinaryThreshold);
+}
+
+void SmartDetector::initialize() {
+    if (mode != Mode::AI) {
+        emit modelReady(bool(traditional_detector_));
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    const auto& settings = controller::AppSettings::instance();
+    registry_            = ai::ModelRegistry(settings.assetsDir());
+    // 先试设置里选中的模型，不存在或加载失败时退回默认模型
+    std::vector<const ai::ModelInfo*> candidates;
+    if (const ai::ModelInfo* m = registry_.find(settings.detectorModel()))
+        candidates.push_back(m);
+    if (const ai::ModelInfo* m = registry_.defaultModel();
+        m && std::find(candidates.begin(), candidates.end(), m) == candidates.end())
+        candidates.push_back(m);
+
+    bool ok = false;
+    for (const ai::ModelInfo* m : candidates) {
+        auto detector = makeDetector();
+        if (!detector->loadModel(m->path, m->mode))
+            continue;
+        qInfo() << "SmartDetector: model" << m->name << "ready in" << timer.elapsed()
+                << "ms, pool" << detector->poolSize();
+        ai_detector_  = std::move(detector);
+        model_name_   = m->name;
+        wanted_model_ = m->name;
+        resetDiskCache();
+        ok = true;
+        emit inputSizeChanged(ai_detector_->inputSize());
+        break;
+    }
+    if (!ok)
+        emit error(QString("模型加载失败：%1/models").arg(settings.assetsDir()));
+    emit modelsDiscovered(registry_.names(), model_name_);
+    if (ok && settings.ensembleMode())
+        setEnsemble(true);
+    emit modelReady(ok);
+}
+
+void SmartDetector::setEnsemble(bool on) {
+    if (mode == Mode::Traditional || on == (mode == Mode::Ensemble))
+        return;
+    if (on && !traditional_detector_) {
+        // 与 AI 模式并存的传统检测器：参数取设置，数字分类器与检测模型放在同一目录
+        const auto& settings = controller::AppSettings::instance();
+        const QString dir    = settings.assetsDir() + "/models/";
+        if (!QFile::exists(dir + "mlp.onnx") || !QFile::exists(dir + "label.txt")) {
+            emit error(QString("融合模式需要数字分类器：%1mlp.onnx").arg(dir));
+            return;
+        }
+        auto classifier = std::make_shared<const rm_auto_aim::NumberClassifier>(
+            (dir + "mlp.onnx").toStdString(), (dir + "label.txt").toStdString(),
+            settings.numberClassifierThreshold() / 100.0);
+        traditional_detector_ = std::make_shared<const Detector>(
+            settings.binaryThreshold(), Detector::LightParams{}, Detector::ArmorParams{},
+            std::move(classifier));
+        fuse_params_.min_number_conf = settings.numberClassifierThreshold() / 100.f;
+    }
+    mode = on ? Mode::Ensemble : Mode::AI;
+    if (ai_detector_)
+        fuse_params_.iou_threshold = ai_detector_->nmsParams().iou_threshold;
+    clearCache(); // 结果随模式变化
+    tuning_.valid = false;
+    resetDiskCache();
+    qInfo() << "SmartDetector: ensemble" << (on ? "on" : "off");
+}
+
+std::unique_ptr<ai::Detector> SmartDetector::makeDetector() const {
+    const auto& settings = controller::AppSettings::instance();
+    auto detector        = std::make_unique<ai::Detector>();
+    detector->setCacheDir(settings.modelCacheDir());
+    detector->setProfile(ai::Detector::profileFromName(settings.performanceProfile()));
+    detector->setInputSize(settings.inputSize());
+    ai::NmsParams nms;
+    nms.iou_threshold = settings.nmsIouThreshold();
+    nms.polygon_iou   = settings.nmsPolygonIou();
+    detector->setNmsParams(nms);
+    ai::Detector::TileParams tiles;
+    tiles.enabled = settings.tiledInference();
+    tiles.tile    = settings.tileSize();
+    tiles.overlap = settings.tileOverlap();
+    detector->setTileParams(tiles);
+    return detector;
+}
+
+void SmartDetector::selectModel(const QString& name) {
+    if (mode == Mode::Traditional) {
+        // 菜单的勾选已经跟着点击移动，重新告诉界面实际在用的模型
+        emit modelsDiscovered(registry_.names(), model_name_);
+        return;
+    }
+    wanted_model_ = name;
+    if (name == model_name_ || name == loading_model_)
+        return;
+    if (previous_detector_ && name == previous_model_name_) {
+        // 回滚：热备模型已编译好，只需对齐切换期间改过的性能配置与输入尺寸
+        auto detector = previous_detector_;
+        if (ai_detector_) {
+            detector->setProfile(ai_detector_->profile());
+            detector->setInputSize(ai_detector_->inputSize());
+        }
+        installDetector(std::move(detector), name);
+        return;
+    }
+    // 同一时间只编译一个模型，在途的完成后按 wanted_model_ 继续
+    if (loading_model_.isEmpty())
+        startModelLoad(name);
+}
+
+void SmartDetector::startModelLoad(const QString& name) {
+    const ai::ModelInfo* info = registry_.find(name);
+    if (!info) {
+        // 可能是刚拷进目录的新模型
+        registry_.rescan();
+        emit modelsDiscovered(registry_.names(), model_name_);
+        info = registry_.find(name);
+    }
+    if (!info) {
+        wanted_model_ = model_name_;
+        emit error(QString("找不到模型：%1").arg(name));
+        return;
+    }
+
+    std::shared_ptr<ai::Detector> detector = makeDetector();
+    if (ai_detector_) {
+        detector->setProfile(ai_detector_->profile());
+        detector->setInputSize(ai_detector_->inputSize());
+    }
+    loading_model_ = name;
+    // 读模型 + 编译在后台线程，检测线程照常处理请求；完成后排队回检测线程切换
+    model_load_ = std::async(std::launch::async, [this, detector, m = *info] {
+        QElapsedTimer timer;
+        timer.start();
+        const bool ok = detector->loadModel(m.path, m.mode);
+        qInfo() << "SmartDetector: background load of" << m.name << (ok ? "done" : "failed")
+                << "in" << timer.elapsed() << "ms";
+        QMetaObject::invokeMethod(
+            this, [this, detector, ok, name = m.name] {
+                finishModelLoad(ok ? detector : nullptr, name);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void SmartDetector::finishModelLoad(
+    std::shared_ptr<ai::Detector> detector, const QString& name) {
+    loading_model_.clear();
+    if (!detector) {
+        if (wanted_model_ == name) {
+            wanted_model_ = model_name_;
+            emit modelsDiscovered(registry_.names(), model_name_); // 勾选退回在用的模型
+        }
+        emit error(QString("模型加载失败：%1").arg(name));
+    } else if (wanted_model_ == name) {
+        installDetector(std::move(detector), name);
+    } else {
+        // 加载期间用户又选了别的模型：这份留作热备
+        previous_detector_   = std::move(detector);
+        previous_model_name_ = name;
+    }
+    if (wanted_model_ != model_name_)
+        selectModel(wanted_model_);
+}
+
+void SmartDetector::installDetector(std::shared_ptr<ai::Detector> detector, const QString& name) {
+    previous_detector_   = std::exchange(ai_detector_, std::move(detector));
+    previous_model_name_ = std::exchange(model_name_, name);
+    clearCache();
+    tuning_.valid = false; // 融合模式缓存的 AI 结果作废
+    resetDiskCache();
+    qInfo() << "SmartDetector: switched model" << previous_model_name_ << "->" << name;
+    emit modelChanged(name);
+    emit inputSizeChanged(ai_detector_->inputSize());
+    emit modelReady(ai_detector_->ready());
 }
 
 void SmartDetector::setBinaryThreshold(int thres) {
-    if (traditional_detector_)
-        traditional_detector_->binary_thres = thres;
+    // 拖动期间每次都重新计时，停顿 kThresholdDebounceMs 后只应用最后一个值
+    pending_threshold_ = thres;
+    threshold_timer_.start();
 }
 
-void SmartDetector::detect(const QImage& image) {
+void SmartDetector::applyBinaryThreshold() {
+    const int thres = pending_threshold_;
+    if (!traditional_detector_ || traditional_detector_->binary_thres == thres)
+        return;
+    // 换一个新实例，正在并行跑的传统检测继续用它手里的旧实例
+    const Detector& d     = *traditional_detector_;
+    traditional_detector_ = std::make_shared<const Detector>(thres, d.l, d.a, d.classifier);
+    clearCache(); // 结果随阈值变化
+    if (mode == Mode::AI)
+        return;
+    // 磁盘缓存的指纹含阈值。拖动期间不跟着换目录，等下一次按文件检测时再换
+    if (mode == Mode::Ensemble)
+        disk_cache_stale_ = true;
+
+    quint64 active = 0;
+    Request last;
+    {
+        QMutexLocker lock(&queue_mutex_);
+        active = active_frame_;
+        last   = last_request_;
+    }
+    QElapsedTimer timer;
+    timer.start();
     try {
-        cv::Mat mat = qimageToMat(image);
-        detectMat(mat);
+        QVector<Armor> armors;
+        if (tuning_.valid && tuning_.frame_id == active) {
+            // 灰度图沿用，二值化 → 轮廓 → 灯条 → 配对 → 分类
+            traditional_detector_->detect(tuning_.rgb, tuning_.result, Detector::Stage::Binary);
+            armors = toArmors(tuning_.result.armors);
+            if (mode == Mode::Ensemble)
+                armors = ensemble::fuse(tuning_.ai_armors, armors, fuse_params_);
+        } else if (last.frame_id == active && !last.image.isNull()) {
+            // 当前帧来自结果缓存、没有中间结果：整帧重跑一次，之后再调就是增量的
+            tuning_.rgb.release();
+            armors              = runDetection(last.image, &tuning_);
+            tuning_.frame_id    = active;
+            tuning_.source_path = last.source_path;
+            tuning_.valid       = !tuning_.rgb.empty();
+        } else {
+            return;
+        }
+        if (!tuning_.source_path.isEmpty())
+            storeCache(cacheKey(tuning_.source_path), armors);
+        qInfo() << "SmartDetector: binary threshold" << thres << "re-detected in"
+                << timer.elapsed() << "ms";
+        emit detected(active, armors);
     } catch (const std::exception& e) {
-        emit error(QString("SmartDetector::detect(QImage) error: %1").arg(e.what()));
+        emit error(QString("SmartDetector: re-detect error: %1").arg(e.what()));
     }
 }
 
-void SmartDetector::detectMat(const cv::Mat& mat) {
-    qInfo() << "detect once";
-    try {
-        cv::Mat input;
-        // 统一转为 BGR 8UC3（取决于你 detector 的预期，这里假定 BGR）
-        if (mat.empty()) {
-            emit error("Input Mat is empty.");
+void SmartDetector::setPerformanceProfile(const QString& name) {
+    if (!ai_detector_)
+        return;
+    QElapsedTimer timer;
+    timer.start();
+    ai_detector_->setProfile(ai::Detector::profileFromName(name));
+    clearCache(); // 精度可能变化，旧结果作废；磁盘缓存按含推理精度的指纹换目录
+    tuning_.valid = false;
+    resetDiskCache();
+    qInfo() << "SmartDetector: profile" << name << "applied in" << timer.elapsed() << "ms";
+    emit modelReady(ai_detector_->ready());
+}
+
+void SmartDetector::setInputSize(int size) {
+    if (!ai_detector_) {
+        // 没有 AI 模型可切：让界面退回设置里的档位
+        emit inputSizeChanged(controller::AppSettings::instance().inputSize());
+        return;
+    }
+    if (size == ai_detector_->inputSize()) {
+        emit inputSizeChanged(size);
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = ai_detector_->setInputSize(size);
+    clearCache(); // 结果随输入尺寸变化
+    tuning_.valid = false;
+    resetDiskCache();
+    qInfo() << "SmartDetector: input size" << ai_detector_->inputSize() << "applied in"
+            << timer.elapsed() << "ms";
+    if (!ok)
+        emit error(QString("模型无法切换到输入尺寸 %1").arg(size));
+    emit inputSizeChanged(ai_detector_->inputSize());
+    emit modelReady(ai_detector_->ready());
+}
+
+void SmartDetector::submit(const QImage& image, quint64 frame_id, const QString& source_path) {
+    // 命中缓存：直接在调用线程（GUI）发结果，不经过检测线程。请求照样记下，
+    // 之后在这一帧上调阈值时整帧重跑它
+    if (!source_path.isEmpty()) {
+        QVector<Armor> cached;
+        if (lookupCache(cacheKey(source_path), cached)) {
+            {
+                QMutexLocker lock(&queue_mutex_);
+                last_request_ = {image, frame_id, source_path};
+            }
+            emit detected(frame_id, cached);
             return;
         }
-        if (mat.type() == CV_8UC3) {
-            input = mat.clone();
-            // 如果是 RGB，可在这里 swap：cv::cvtColor(mat, input, cv::COLOR_RGB2BGR);
-        } else if (mat.type() == CV_8UC4) {
-            cv::cvtColor(mat, input, cv::COLOR_BGRA2BGR);
-        } else if (mat.type() == CV_8UC1) {
-            cv::cvtColor(mat, input, cv::COLOR_GRAY2BGR);
-        } else {
-            mat.convertTo(input, CV_8UC3);
+    }
+
+    bool schedule = false;
+    {
+        QMutexLocker lock(&queue_mutex_);
+        pending_.push_back({image, frame_id, source_path});
+        while (pending_.size() > size_t(kMaxPendingRequests))
+            pending_.pop_front();
+        schedule         = !drain_scheduled_;
+        drain_scheduled_ = true;
+    }
+    // 只投递一次处理事件，排队期间新到的请求会覆盖旧请求
+    if (schedule)
+        QMetaObject::invokeMethod(this, &SmartDetector::processPending, Qt::QueuedConnection);
+}
+
+void SmartDetector::prefetch(const QStringList& paths) {
+    bool schedule = false;
+    {
+        QMutexLocker lock(&queue_mutex_);
+        prefetch_.assign(paths.begin(), paths.end());
+        schedule         = !prefetch_.empty() && !drain_scheduled_;
+        drain_scheduled_ = drain_scheduled_ || schedule;
+    }
+    if (schedule)
+        QMetaObject::invokeMethod(this, &SmartDetector::processPending, Qt::QueuedConnection);
+}
+
+void SmartDetector::setActiveFrame(quint64 frame_id) {
+    QMutexLocker lock(&queue_mutex_);
+    active_frame_ = frame_id;
+    std::erase_if(pending_, [frame_id](const Request& r) { return r.frame_id != frame_id; });
+}
+
+void SmartDetector::processPending() {
+    Request req;
+    bool have_request = false;
+    size_t dropped    = 0;
+    QString prefetch_path;
+    bool more = false;
+    {
+        QMutexLocker lock(&queue_mutex_);
+        drain_scheduled_ = false;
+        if (!pending_.empty()) {
+            // latest wins：只处理最新请求，其余直接丢弃
+            req          = std::move(pending_.back());
+            dropped      = pending_.size() - 1;
+            have_request = req.frame_id == active_frame_;
+            pending_.clear();
+            if (have_request)
+                last_request_ = req;
+        } else if (!prefetch_.empty()) {
+            prefetch_path = prefetch_.front();
+            prefetch_.pop_front();
         }
+        // 预取每次只做一张，做完回到事件循环，期间到达的用户请求排在剩余预取之前
+        more             = !prefetch_.empty();
+        drain_scheduled_ = more;
+    }
+    if (more)
+        QMetaObject::invokeMethod(this, &SmartDetector::processPending, Qt::QueuedConnection);
 
-        // --- 同步版本 ---
-        QVector<::Armor> sigArmors;
-        if (ai_detector_) {
-            sigArmors = ai_detector_->detect(input);
-        } else {
-            qWarning() << "ai detector not initialized.";
+    if (have_request) {
+        qDebug() << "SmartDetector: detect frame" << req.frame_id << "coalesced" << dropped
+                 << "stale request(s)";
+        try {
+            // 顺带留下传统检测的中间结果，之后调阈值时从二值化往下增量重算
+            TuningFrame* keep = mode == Mode::AI ? nullptr : &tuning_;
+            tuning_.valid     = false;
+            tuning_.rgb.release();
+
+            QVector<Armor> armors;
+            if (req.source_path.isEmpty()) {
+                armors = runDetection(req.image, keep);
+            } else {
+                armors = detectFile(req.source_path, req.image, keep);
+                storeCache(cacheKey(req.source_path), armors);
+            }
+            tuning_.frame_id    = req.frame_id;
+            tuning_.source_path = req.source_path;
+            tuning_.valid       = !tuning_.rgb.empty(); // 命中磁盘缓存时没有中间结果
+            emit detected(req.frame_id, armors);
+        } catch (const std::exception& e) {
+            emit error(QString("SmartDetector::detect error: %1").arg(e.what()));
         }
+    } else if (!prefetch_path.isEmpty()) {
+        runPrefetch(prefetch_path);
+    }
+}
 
-        // 调试图像（可选）
-        // cv::Mat draw = input.clone();
-        // QImage anno  = matToQImage(draw);
+void SmartDetector::runPrefetch(const QString& path) {
+    if (mode == Mode::Traditional || !ai_detector_ || !ai_detector_->ready())
+        return;
+    const QString key = cacheKey(path);
+    QVector<Armor> cached;
+    if (lookupCache(key, cached))
+        return;
+    try {
+        storeCache(key, detectFile(path, {}));
+    } catch (const std::exception& e) {
+        qDebug() << "SmartDetector: prefetch failed" << path << e.what();
+    }
+}
 
-        qDebug() << "emit detected";
-        emit detected(sigArmors);
+QVector<Armor> SmartDetector::detectFile(
+    const QString& path, const QImage& image, TuningFrame* keep) {
+    if (disk_cache_stale_)
+        resetDiskCache();
+    QByteArray key;
+    if (disk_cache_) {
+        key = DetectionCache::fileHash(path);
+        QVector<Armor> cached;
+        if (!key.isEmpty() && disk_cache_->lookup(key, cached))
+            return cached;
+    }
+    QImage img = image;
+    if (img.isNull()) {
+        // 与 FileService::openFileAt 相同的读法，保证和画布上的图像一致
+        QImageReader reader(path);
+        reader.setAutoTransform(true);
+        img = reader.read();
+        if (img.isNull())
+            throw std::runtime_error(reader.errorString().toStdString());
+    }
+    QVector<Armor> armors = runDetection(img, keep);
+    if (!key.isEmpty())
+        disk_cache_->store(key, armors);
+    return armors;
+}
+
+void SmartDetector::resetDiskCache() {
+    disk_cache_stale_    = false;
+    const auto& settings = controller::AppSettings::instance();
+    if (!settings.resultCacheEnabled() || !ai_detector_) {
+        disk_cache_.reset();
+        return;
+    }
+    QByteArray fingerprint = ai_detector_->fingerprint();
+    if (mode == Mode::Ensemble) {
+        // 融合结果另算指纹：传统路径的参数也会改变输出
+        const QString params = QString("|ensemble|bin=%1|conf=%2|iou=%3")
+                                   .arg(traditional_detector_->binary_thres)
+                                   .arg(double(fuse_params_.min_number_conf))
+                                   .arg(double(fuse_params_.iou_threshold));
+        fingerprint = QCryptographicHash::hash(
+                          fingerprint + params.toUtf8(), QCryptographicHash::Sha1)
+                          .toHex();
+    }
+    // 同一个根目录只统计一次大小，之后换指纹只是换子目录，其它指纹的结果保留
+    const QString root     = settings.resultCacheDir();
+    const qint64 max_bytes = qint64(settings.resultCacheMaxMB()) * 1024 * 1024;
+    if (!disk_cache_ || disk_cache_->root() != root)
+        disk_cache_ = std::make_unique<DetectionCache>(root, max_bytes);
+    disk_cache_->setMaxBytes(max_bytes);
+    disk_cache_->setFingerprint(fingerprint);
+}
+
+// 路径 + 修改时间：文件被覆盖后旧结果自动失效
+QString SmartDetector::cacheKey(const QString& path) {
+    const QFileInfo fi(path);
+    return fi.absoluteFilePath() + '|' + QString::number(fi.lastModified().toMSecsSinceEpoch());
+}
+
+bool SmartDetector::lookupCache(const QString& key, QVector<Armor>& out) {
+    QMutexLocker lock(&cache_mutex_);
+    const auto it = cache_.constFind(key);
+    if (it == cache_.constEnd())
+        return false;
+    out = it.value();
+    return true;
+}
+
+void SmartDetector::storeCache(const QString& key, const QVector<Armor>& armors) {
+    QMutexLocker lock(&cache_mutex_);
+    if (!cache_.contains(key))
+        cache_order_.push_back(key);
+    cache_.insert(key, armors);
+    while (cache_order_.size() > size_t(kMaxCachedResults)) {
+        cache_.remove(cache_order_.front());
+        cache_order_.pop_front();
+    }
+}
+
+void SmartDetector::clearCache() {
+    QMutexLocker lock(&cache_mutex_);
+    cache_.clear();
+    cache_order_.clear();
+}
+
+void SmartDetector::detect(const QImage& image, quint64 frame_id) {
+    try {
+        emit detected(frame_id, runDetection(image));
+    } catch (const std::exception& e) {
+        emit error(QString("SmartDetector::detect(QImage) error: %1").arg(e.what()));
+    }
+}
 
+void SmartDetector::detectMat(const cv::Mat& mat, quint64 frame_id) {
+    qInfo() << "detect once";
+    try {
+        const QVector<::Armor> sigArmors = runDetection(mat);
+        qDebug() << "emit detected";
+        emit detected(frame_id, sigArmors);
     } catch (const std::exception& e) {
         emit error(QString("SmartDetector::detectMat error: %1").arg(e.what()));
     }
 }
 
+QVector<::Armor> SmartDetector::runDetection(const QImage& image, TuningFrame* keep) {
+    const QImageView view = qimageView(image); // view.holder 保证推理期间像素有效
+    return runDetection(view.mat, view.order, keep);
+}
+
+QVector<::Armor> SmartDetector::runDetection(
+    const cv::Mat& mat, ai::PixelOrder order, TuningFrame* keep) {
+    if (mat.empty())
+        throw std::runtime_error("Input Mat is empty.");
+    // 8 位 3/4 通道原样传下去，通道挑选与 R/B 交换都在预处理里一遍完成
+    cv::Mat input = mat;
+    if (mat.type() == CV_8UC1) {
+        cv::cvtColor(mat, input, cv::COLOR_GRAY2BGR);
+        order = ai::PixelOrder::BGR;
+    } else if (mat.type() != CV_8UC3 && mat.type() != CV_8UC4) {
+        mat.convertTo(input, CV_8U);
+        if (input.channels() != 3 && input.channels() != 4)
+            throw std::runtime_error("Unsupported Mat channel count.");
+    }
+
+    if (mode == Mode::Traditional)
+        return runTraditional(traditional_detector_, input, order, keep);
+
+    // 融合模式：传统检测在另一个线程上与 AI 推理并行，总耗时接近两者中较慢的一个
+    std::future<QVector<::Armor>> traditional;
+    if (mode == Mode::Ensemble && traditional_detector_)
+        traditional = std::async(
+            std::launch::async, [this, detector = traditional_detector_, input, order, keep] {
+                return runTraditional(detector, input, order, keep);
+            });
+
+    // --- 同步版本 ---
+    QVector<::Armor> sigArmors;
+    if (ai_detector_) {
+        sigArmors = ai_detector_->detect(input, nullptr, order);
+    } else {
+        qWarning() << "ai detector not initialized.";
+    }
+    if (traditional.valid()) {
+        // keep 由传统检测线程填写，get() 之后才可读写
+        QVector<::Armor> traditional_armors = traditional.get();
+        if (keep)
+            keep->ai_armors = sigArmors;
+        sigArmors = ensemble::fuse(sigArmors, traditional_armors, fuse_params_);
+    }
+
+    // 调试图像（可选）
+    // cv::Mat draw = input.clone();
+    // QImage anno  = matToQImage(draw);
+    return sigArmors;
+}
+
+QVector<::Armor> SmartDetector::runTraditional(
+    const std::shared_ptr<const Detector>& detector, const cv::Mat& input, ai::PixelOrder order,
+    TuningFrame* keep) const {
+    if (!detector || !detector->classifier)
+        return {};
+    // rm_auto_aim::Detector 吃 RGB 8UC3。input 可能直接指向 QImage 的像素（融合模式下
+    // AI 推理同时在读），转换必须写到新内存里
+    const bool rgb = order == ai::PixelOrder::RGB;
+    cv::Mat img;
+    if (input.channels() == 4)
+        cv::cvtColor(input, img, rgb ? cv::COLOR_RGBA2RGB : cv::COLOR_BGRA2RGB);
+    else if (!rgb)
+        cv::cvtColor(input, img, cv::COLOR_BGR2RGB);
+    else
+        img = keep ? input.clone() : input; // 留作增量重算的输入要自有内存
+
+    if (!keep)
+        return toArmors(detector->detect(img));
+    detector->detect(img, keep->result);
+    keep->rgb = img;
+    return toArmors(keep->result.armors);
+}
+
+QVector<::Armor> SmartDetector::toArmors(const std::vector<rm_auto_aim::Armor>& armors) const {
+    QVector<::Armor> out;
+    for (const rm_auto_aim::Armor& t : armors) {
+        ::Armor a;
+        if (ensemble::toArmor(t, fuse_params_.min_number_conf, a))
+            out.push_back(std::move(a));
+    }
+    return out;
+}
+
 void SmartDetector::resetNumberClassifier(
     const QString& model_path, const QString& label_path, float threshold) {
     if (traditional_detector_) {
-        traditional_detector_->classifier.reset();
-        traditional_detector_->classifier = std::make_unique<rm_auto_aim::NumberClassifier>(
-            model_path.toStdString(), label_path.toStdString(), threshold);
+        const Detector& d     = *traditional_detector_;
+        traditional_detector_ = std::make_shared<const Detector>(
+            d.binary_thres, d.l, d.a,
+            std::make_shared<const rm_auto_aim::NumberClassifier>(
+                model_path.toStdString(), label_path.toStdString(), threshold));
     } else {
         qWarning() << "traditional detector not initialized.";
     }
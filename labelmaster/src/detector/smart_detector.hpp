@@ -1,11 +1,20 @@
 #pragma once
 #include "ai/detector.hpp"
+#include "ai/model_registry.hpp"
+#include "service/detection_cache.hpp"
+#include <QHash>
 #include <QImage>
+#include <QMutex>
+#include <QStringList>
 #include <QObject>
+#include <QTimer>
 #include <QVector>
+#include <deque>
+#include <future>
 #include <memory>
 
 #include "armor.hpp"                // rm_auto_aim::Armor
+#include "ensemble.hpp"
 #include "traditional/detector.hpp" // 你给的头
 #include "types.hpp"
 #include <opencv2/core.hpp>
@@ -13,36 +22,169 @@
 // 声明给 Qt 的元类型（用于跨线程信号）
 Q_DECLARE_METATYPE(std::vector<rm_auto_aim::Armor>)
 
+// 运行在独立的检测线程上（见 main.cpp 中的 moveToThread）。
+// GUI 线程通过 submit() 投递请求，请求队列有上限，处理时只保留最新的一帧（latest wins）。
+// 空闲时按 prefetch() 给出的路径（浏览顺序上的后几张）预先检测，结果按 路径+修改时间 缓存，
+// 之后对这些图片的 submit() 直接在调用线程返回缓存结果。用户请求总是优先于预取任务。
+// 内存缓存之下还有按 图片内容 + 模型指纹 持久化的 DetectionCache，重开同一数据集时免推理。
+// 模型可在运行中切换：新模型在后台线程编译，完成后回到检测线程、在两次推理之间替换，
+// 排队中的请求不受影响；被换下的模型保持编译状态，切回时立即生效。
 class SmartDetector : public QObject {
     Q_OBJECT
 public:
-    enum Mode { Traditional, AI };
+    // Ensemble：AI 与传统检测并行跑同一帧，结果经 ensemble::fuse 融合
+    enum Mode { Traditional, AI, Ensemble };
+    // 待处理请求上限：超出时丢弃最旧的请求
+    static constexpr int kMaxPendingRequests = 2;
+    // 检测结果缓存上限（条），超出时淘汰最早写入的
+    static constexpr int kMaxCachedResults = 16;
+    // 调二值化阈值的防抖间隔（毫秒）：拖动滑块期间只在停顿后重算一次
+    static constexpr int kThresholdDebounceMs = 40;
+
     explicit SmartDetector(
         int bin_thres, const rm_auto_aim::Detector::LightParams& lp,
         const rm_auto_aim::Detector::ArmorParams& ap, QObject* parent = nullptr);
+    // AI 模式：构造时不加载模型，由 initialize() 在检测线程上完成
     explicit SmartDetector(QObject* parent = nullptr);
 
-    void setBinaryThreshold(int thres);
-
 signals:
-    // 主结果：一帧检测出的装甲板
-    void detected(const QVector<Armor>& armors);
+    // 主结果：一帧检测出的装甲板，frame_id 为请求时画布上的帧号
+    void detected(quint64 frame_id, const QVector<Armor>& armors);
     // 可选调试输出：二值图与标注图（若不用可删）
     void debugImages(const QImage& bin, const QImage& annotated);
     // 出错时
     void error(const QString& message);
+    // initialize() 完成：ok 为 false 表示模型加载失败
+    void modelReady(bool ok);
+    // initialize() 扫描到的模型（ModelInfo::name）与当前使用的模型
+    void modelsDiscovered(const QStringList& names, const QString& current);
+    // 模型切换完成
+    void modelChanged(const QString& name);
+    // 实际生效的网络输入尺寸：切换失败、模型退回自身尺寸或换了模型时都会发出
+    void inputSizeChanged(int size);
 
 public slots:
-    // 传入 QImage
-    void detect(const QImage& image);
-    // 传入 cv::Mat（BGR/RGB 都可，见实现）
-    void detectMat(const cv::Mat& mat);
+    // 加载并编译模型（耗时，连接到 QThread::started 在检测线程上执行），完成后发 modelReady
+    void initialize();
+    // 切换性能配置并重新编译模型（耗时，应排队到检测线程执行），完成后发 modelReady
+    void setPerformanceProfile(const QString& name);
+    // 切换网络输入尺寸档位（首次切到某档时编译，应排队到检测线程执行），完成后发 modelReady
+    void setInputSize(int size);
+    // 切换检测模型（应排队到检测线程执行）：热备模型立即换回，否则后台编译，完成后发 modelChanged
+    void selectModel(const QString& name);
+    // AI 模式下开关融合模式（应排队到检测线程执行）；首次打开时创建传统检测器与数字分类器
+    void setEnsemble(bool on);
+    // 调整传统检测的二值化阈值（应排队到检测线程执行）：连续调用经防抖合并为一次，
+    // 当前帧沿用缓存的灰度图，只从二值化往下重算并重新发出 detected
+    void setBinaryThreshold(int thres);
+    // 线程安全：任意线程调用，入队后异步在检测线程处理（需 DirectConnection 连接）
+    // source_path 非空表示 image 就是该文件的完整内容，可以查/写结果缓存
+    void submit(const QImage& image, quint64 frame_id, const QString& source_path = {});
+    // 线程安全：替换预取队列，不在新列表中的旧任务随之取消（需 DirectConnection 连接）
+    void prefetch(const QStringList& paths);
+    // 线程安全：画布切换到新帧，丢弃所有其它帧的待处理请求（需 DirectConnection 连接）
+    void setActiveFrame(quint64 frame_id);
+
+    // 同步检测：在调用线程上直接执行
+    void detect(const QImage& image, quint64 frame_id = 0);
+    // 传入 cv::Mat（按 BGR 解释，8UC1 / 8UC3 / 8UC4 均可）
+    void detectMat(const cv::Mat& mat, quint64 frame_id = 0);
     // 重置分类器
     void resetNumberClassifier(
         const QString& model_path, const QString& label_path, float threshold);
 
+private slots:
+    void processPending();
+
 private:
+    struct Request {
+        QImage image;
+        quint64 frame_id = 0;
+        QString source_path;
+    };
+
+    // 当前帧的传统检测输入与各阶段中间结果，调阈值时增量重算用（只在检测线程上访问）
+    struct TuningFrame {
+        quint64 frame_id = 0;
+        QString source_path;
+        cv::Mat rgb; // 传统检测输入，RGB 8UC3，自有内存
+        rm_auto_aim::Detector::Result result;
+        QVector<Armor> ai_armors; // 融合模式下 AI 一侧的结果，重算时直接复用
+        bool valid = false;
+    };
+
+    // 8UC3 / 8UC4 直接交给预处理（order 为前三个通道顺序），其余类型先转 BGR；出错抛异常。
+    // keep 非空时把传统检测的输入与中间结果留在其中（rgb 非空表示填好了）
+    QVector<Armor> runDetection(
+        const cv::Mat& mat, ai::PixelOrder order = ai::PixelOrder::BGR,
+        TuningFrame* keep = nullptr);
+    // 按 qimageView 包装像素后推理，不拷贝
+    QVector<Armor> runDetection(const QImage& image, TuningFrame* keep = nullptr);
+    // 传统检测并转成四角点 ::Armor；input 同 runDetection，内部转 RGB。
+    // detector 由调用方取快照传入，可在任意线程执行
+    QVector<Armor> runTraditional(
+        const std::shared_ptr<const rm_auto_aim::Detector>& detector, const cv::Mat& input,
+        ai::PixelOrder order, TuningFrame* keep = nullptr) const;
+    // 传统检测结果转 ::Armor，按 fuse_params_.min_number_conf 过滤
+    QVector<Armor> toArmors(const std::vector<rm_auto_aim::Armor>& armors) const;
+    void runPrefetch(const QString& path);
+    // 整图检测：先查磁盘缓存，未命中再推理并写回；image 为空时才从 path 读图
+    QVector<Armor> detectFile(
+        const QString& path, const QImage& image, TuningFrame* keep = nullptr);
+    // 构造时调用：单次触发，到期后 applyBinaryThreshold
+    void setupThresholdTimer();
+    // 防抖定时器到期：换上新阈值的传统检测器并重算当前帧
+    void applyBinaryThreshold();
+    // 磁盘缓存切到当前模型指纹的目录（首次或根目录变化时才新建），检测线程上调用
+    void resetDiskCache();
+    // 按 AppSettings 配好缓存目录 / 性能配置 / 输入尺寸 / NMS / 分块，尚未加载模型
+    std::unique_ptr<ai::Detector> makeDetector() const;
+    // 以下均在检测线程上调用
+    void startModelLoad(const QString& name);
+    void finishModelLoad(std::shared_ptr<ai::Detector> detector, const QString& name);
+    void installDetector(std::shared_ptr<ai::Detector> detector, const QString& name);
+
+    // 结果缓存（cache_mutex_ 保护），键见 cacheKey()
+    static QString cacheKey(const QString& path);
+    bool lookupCache(const QString& key, QVector<Armor>& out);
+    void storeCache(const QString& key, const QVector<Armor>& armors);
+    void clearCache();
+
     Mode mode = Mode::AI;
-    std::unique_ptr<rm_auto_aim::Detector> traditional_detector_;
-    std::unique_ptr<ai::Detector> ai_detector_;
+    // 不可变、可多线程共用；改参数时整体替换（共享数字分类器）
+    std::shared_ptr<const rm_auto_aim::Detector> traditional_detector_;
+    ensemble::FuseParams fuse_params_;
+    // 检测器只在检测线程上使用和替换；shared_ptr 便于和热备 / 后台加载交接
+    std::shared_ptr<ai::Detector> ai_detector_;
+    QString model_name_;
+    ai::ModelRegistry registry_;
+    std::shared_ptr<ai::Detector> previous_detector_; // 上一个模型，保持编译状态以便回滚
+    QString previous_model_name_;
+    QString loading_model_; // 后台加载中的模型，空表示没有
+    QString wanted_model_;  // 最近一次 selectModel 请求的模型
+
+    // 请求队列（queue_mutex_ 保护）
+    QMutex queue_mutex_;
+    std::deque<Request> pending_;
+    quint64 active_frame_ = 0;
+    bool drain_scheduled_ = false;
+    std::deque<QString> prefetch_; // 待预取的图片路径
+
+    QMutex cache_mutex_;
+    QHash<QString, QVector<Armor>> cache_;
+    std::deque<QString> cache_order_; // 写入顺序，用于淘汰
+
+    // 交互调阈值：tuning_ 可用时增量重算，否则整帧重跑 last_request_。
+    // tuning_ 只在检测线程上访问；last_request_ 在缓存命中时由调用线程写，queue_mutex_ 保护
+    TuningFrame tuning_;
+    Request last_request_;
+    QTimer threshold_timer_{this}; // 以 this 为父对象，随 moveToThread 一起迁到检测线程
+    int pending_threshold_ = 0;
+
+    // 磁盘缓存：只在检测线程上创建和访问，无需加锁；未启用时为空
+    std::unique_ptr<DetectionCache> disk_cache_;
+    bool disk_cache_stale_ = false; // 融合模式调过阈值、指纹待更新，下次 detectFile 前切换
+
+    // 后台模型加载；放在最后，析构时最先等待加载线程结束
+    std::future<void> model_load_;
 };
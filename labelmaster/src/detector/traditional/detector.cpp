@@ -4,6 +4,7 @@
 // OpenCV
 #include <opencv2/core.hpp>
 #include <opencv2/core/base.hpp>
+#include <opencv2/core/hal/intrin.hpp>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/core/types.hpp>
 #include <opencv2/imgproc.hpp>
@@ -11,30 +12,69 @@
 // STD
 #include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <numeric>
 #include <vector>
 
 #include "detector.hpp"
 
 namespace rm_auto_aim {
-Detector::Detector(const int& bin_thres, const LightParams& l, const ArmorParams& a)
+Detector::Detector(
+    const int& bin_thres, const LightParams& l, const ArmorParams& a,
+    std::shared_ptr<const NumberClassifier> classifier)
     : binary_thres(bin_thres)
     , l(l)
-    , a(a) {}
+    , a(a)
+    , classifier(std::move(classifier)) {}
 
-std::vector<Armor> Detector::detect(const cv::Mat& input) {
-    binary_img = preprocessImage(input);
-    lights_    = findLights(input, binary_img);
-    armors_    = matchLights(lights_);
+std::vector<Armor> Detector::detect(const cv::Mat& input) const {
+    Result result;
+    detect(input, result);
+    return std::move(result.armors);
+}
 
-    if (!armors_.empty()) {
-        classifier->extractNumbers(input, armors_);
-        classifier->classify(armors_);
-    }
+void Detector::detect(const cv::Mat& input, Result& result) const {
+    detect(input, result, Stage::Gray);
+}
 
-    return armors_;
+void Detector::detect(const cv::Mat& input, Result& result, Stage from) const {
+    const bool color_diff = l.binarization == LightParams::Binarization::ColorDifference;
+    switch (from) {
+    case Stage::Gray:
+        if (!color_diff)
+            cv::cvtColor(input, result.gray_img, cv::COLOR_RGB2GRAY);
+        [[fallthrough]];
+    case Stage::Binary:
+        if (color_diff)
+            colorDifference(input, result.red_mask, result.blue_mask);
+        else
+            cv::threshold(
+                result.gray_img, result.binary_img, binary_thres, 255, cv::THRESH_BINARY);
+        [[fallthrough]];
+    case Stage::Contours:
+        result.contours.clear();
+        if (color_diff) {
+            findColorContours(
+                result.red_mask, result.blue_mask, result.contours, result.red_contours);
+        } else {
+            cv::findContours(
+                result.binary_img, result.contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+        }
+        [[fallthrough]];
+    case Stage::Lights:
+        result.lights = color_diff ? findLights(input, result.contours, result.red_contours)
+                                   : findLights(input, result.contours);
+        [[fallthrough]];
+    case Stage::Armors:
+        result.armors = matchLights(result.lights);
+        if (!result.armors.empty() && classifier) {
+            classifier->extractNumbers(input, result.armors);
+            classifier->classify(result.armors);
+        }
+    }
 }
 
-cv::Mat Detector::preprocessImage(const cv::Mat& rgb_img) {
+cv::Mat Detector::preprocessImage(const cv::Mat& rgb_img) const {
     cv::Mat gray_img;
     cv::cvtColor(rgb_img, gray_img, cv::COLOR_RGB2GRAY);
 
@@ -44,51 +84,141 @@ cv::Mat Detector::preprocessImage(const cv::Mat& rgb_img) {
     return binary_img;
 }
 
-std::vector<Light> Detector::findLights(const cv::Mat& rbg_img, const cv::Mat& binary_img) {
-    using std::vector;
-    vector<vector<cv::Point>> contours;
-    vector<cv::Vec4i> hierarchy;
-    cv::findContours(binary_img, contours, hierarchy, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+std::vector<Light> Detector::findLights(const cv::Mat& rbg_img, const cv::Mat& binary_img) const {
+    std::vector<std::vector<cv::Point>> contours;
+    cv::findContours(binary_img, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    return findLights(rbg_img, contours);
+}
 
-    vector<Light> lights;
+std::vector<Light> Detector::findLights(
+    const cv::Mat& rbg_img, const std::vector<std::vector<cv::Point>>& contours) const {
+    std::vector<Light> lights;
 
-    for (const auto& contour : contours) {
-        if (contour.size() < 5)
-            continue;
+    for (size_t idx = 0; idx < contours.size(); ++idx) {
+        Light light;
+        cv::Rect rect;
+        if (toLight(contours[idx], rbg_img, light, rect)) {
+            light.color = lightColor(rbg_img, contours, int(idx), rect);
+            lights.emplace_back(light);
+        }
+    }
 
-        auto r_rect = cv::minAreaRect(contour);
-        auto light  = Light(r_rect);
-
-        if (isLight(light)) {
-            auto rect = light.boundingRect();
-            if ( // Avoid assertion failed
-                0 <= rect.x && 0 <= rect.width && rect.x + rect.width <= rbg_img.cols && 0 <= rect.y
-                && 0 <= rect.height && rect.y + rect.height <= rbg_img.rows) {
-                int sum_r = 0, sum_b = 0;
-                auto roi = rbg_img(rect);
-                // Iterate through the ROI
-                for (int i = 0; i < roi.rows; i++) {
-                    for (int j = 0; j < roi.cols; j++) {
-                        if (cv::pointPolygonTest(
-                                contour, cv::Point2f(j + rect.x, i + rect.y), false)
-                            >= 0) {
-                            // if point is inside contour
-                            sum_r += roi.at<cv::Vec3b>(i, j)[0];
-                            sum_b += roi.at<cv::Vec3b>(i, j)[2];
-                        }
-                    }
-                }
-                // Sum of red pixels > sum of blue pixels ?
-                light.color = sum_r > sum_b ? RED : BLUE;
-                lights.emplace_back(light);
-            }
+    return lights;
+}
+
+std::vector<Light> Detector::findLights(
+    const cv::Mat& rgb_img, const cv::Mat& red_mask, const cv::Mat& blue_mask) const {
+    std::vector<std::vector<cv::Point>> contours;
+    size_t red_contours = 0;
+    findColorContours(red_mask, blue_mask, contours, red_contours);
+    return findLights(rgb_img, contours, red_contours);
+}
+
+std::vector<Light> Detector::findLights(
+    const cv::Mat& rgb_img, const std::vector<std::vector<cv::Point>>& contours,
+    size_t red_contours) const {
+    std::vector<Light> lights;
+
+    for (size_t idx = 0; idx < contours.size(); ++idx) {
+        Light light;
+        cv::Rect rect;
+        if (toLight(contours[idx], rgb_img, light, rect)) {
+            light.color = idx < red_contours ? RED : BLUE;
+            lights.emplace_back(light);
         }
     }
 
     return lights;
 }
 
-bool Detector::isLight(const Light& light) {
+void Detector::findColorContours(
+    const cv::Mat& red_mask, const cv::Mat& blue_mask,
+    std::vector<std::vector<cv::Point>>& contours, size_t& red_contours) {
+    contours.clear();
+    cv::findContours(red_mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    red_contours = contours.size();
+
+    std::vector<std::vector<cv::Point>> blue_contours;
+    cv::findContours(blue_mask, blue_contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    contours.insert(
+        contours.end(), std::make_move_iterator(blue_contours.begin()),
+        std::make_move_iterator(blue_contours.end()));
+}
+
+bool Detector::toLight(
+    const std::vector<cv::Point>& contour, const cv::Mat& rgb_img, Light& light,
+    cv::Rect& rect) const {
+    if (contour.size() < 5)
+        return false;
+
+    light = Light(cv::minAreaRect(contour));
+    if (!isLight(light))
+        return false;
+
+    rect = light.boundingRect();
+    // Avoid assertion failed
+    return 0 <= rect.x && 0 <= rect.width && rect.x + rect.width <= rgb_img.cols && 0 <= rect.y
+        && 0 <= rect.height && rect.y + rect.height <= rgb_img.rows;
+}
+
+void Detector::colorDifference(
+    const cv::Mat& rgb_img, cv::Mat& red_mask, cv::Mat& blue_mask) const {
+    CV_Assert(rgb_img.type() == CV_8UC3);
+    red_mask.create(rgb_img.size(), CV_8UC1);
+    blue_mask.create(rgb_img.size(), CV_8UC1);
+    const uchar thres = cv::saturate_cast<uchar>(l.color_diff_thres);
+
+    int rows = rgb_img.rows;
+    int cols = rgb_img.cols;
+    if (rgb_img.isContinuous() && red_mask.isContinuous() && blue_mask.isContinuous()) {
+        cols *= rows;
+        rows = 1;
+    }
+    for (int y = 0; y < rows; ++y) {
+        const uchar* src = rgb_img.ptr<uchar>(y);
+        uchar* red       = red_mask.ptr<uchar>(y);
+        uchar* blue      = blue_mask.ptr<uchar>(y);
+        int x            = 0;
+#if CV_SIMD
+        const cv::v_uint8 v_thres = cv::vx_setall_u8(thres);
+        for (; x <= cols - cv::v_uint8::nlanes; x += cv::v_uint8::nlanes) {
+            cv::v_uint8 r, g, b;
+            cv::v_load_deinterleave(src + 3 * x, r, g, b);
+            // 8-bit subtraction saturates: R - B is 0 wherever B >= R, and vice versa
+            cv::v_store(red + x, (r - b) > v_thres);
+            cv::v_store(blue + x, (b - r) > v_thres);
+        }
+#endif
+        for (; x < cols; ++x) {
+            const int r = src[3 * x];
+            const int b = src[3 * x + 2];
+            red[x]      = r - b > thres ? 255 : 0;
+            blue[x]     = b - r > thres ? 255 : 0;
+        }
+    }
+}
+
+int Detector::lightColor(
+    const cv::Mat& rgb_img, const std::vector<std::vector<cv::Point>>& contours, int idx,
+    const cv::Rect& rect) {
+    // Rasterize the contour once into a rect-sized mask. A filled external contour covers
+    // its boundary pixels too, i.e. exactly the pixels where pointPolygonTest(...) >= 0
+    cv::Mat mask(rect.size(), CV_8UC1, cv::Scalar(0));
+    cv::drawContours(
+        mask, contours, idx, cv::Scalar(255), cv::FILLED, cv::LINE_8, cv::noArray(), 0,
+        -rect.tl());
+
+    // Masked channel sums: zero the outside pixels, then one vectorized cv::sum.
+    // 8-bit sums are exact in double, so the comparison matches the integer one
+    cv::Mat masked(rect.size(), rgb_img.type(), cv::Scalar::all(0));
+    rgb_img(rect).copyTo(masked, mask);
+    const cv::Scalar sums = cv::sum(masked);
+
+    // Sum of red pixels > sum of blue pixels ?
+    return sums[0] > sums[2] ? RED : BLUE;
+}
+
+bool Detector::isLight(const Light& light) const {
     // The ratio of light (short side / long side)
     float ratio   = light.width / light.length;
     bool ratio_ok = l.min_ratio < ratio && ratio < l.max_ratio;
@@ -100,7 +230,111 @@ bool Detector::isLight(const Light& light) {
     return is_light;
 }
 
-std::vector<Armor> Detector::matchLights(const std::vector<Light>& lights) {
+namespace {
+// Acceleration structure for containLight: the top / bottom / center of every light, rounded
+// exactly as the implicit Point2f -> Point conversion in Rect::contains does, sorted by x
+class LightPointIndex {
+public:
+    explicit LightPointIndex(const std::vector<Light>& lights) {
+        pts_.reserve(lights.size() * 3);
+        for (int i = 0; i < int(lights.size()); ++i)
+            for (const cv::Point2f& p : {lights[i].top, lights[i].bottom, lights[i].center})
+                pts_.push_back({cv::Point(p), i});
+        std::sort(pts_.begin(), pts_.end(), [](const Entry& a, const Entry& b) {
+            return a.p.x < b.p.x;
+        });
+    }
+
+    // Same answer as the linear scan in Detector::containLight, visiting only the x-slab of rect
+    bool containsOther(
+        const cv::Rect& rect, const std::vector<Light>& lights, const Light& light_1,
+        const Light& light_2) const {
+        auto it = std::lower_bound(
+            pts_.begin(), pts_.end(), rect.x, [](const Entry& e, int x) { return e.p.x < x; });
+        for (; it != pts_.end() && it->p.x < rect.x + rect.width; ++it) {
+            if (it->p.y < rect.y || it->p.y >= rect.y + rect.height)
+                continue;
+            const Light& test_light = lights[it->light];
+            if (test_light.center == light_1.center || test_light.center == light_2.center)
+                continue;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct Entry {
+        cv::Point p;
+        int light;
+    };
+    std::vector<Entry> pts_;
+};
+} // namespace
+
+// Same output (content and order) as matchLightsReference, but each light is only paired with
+// lights close enough to pass isArmor's center distance check, and containment is an index query
+std::vector<Armor> Detector::matchLights(const std::vector<Light>& lights) const {
+    std::vector<Armor> armors;
+    const int n = int(lights.size());
+    if (n < 2)
+        return armors;
+
+    // Lights sorted by center x for the pairing window
+    std::vector<int> by_x(n);
+    std::iota(by_x.begin(), by_x.end(), 0);
+    std::sort(by_x.begin(), by_x.end(), [&](int i, int j) {
+        return lights[i].center.x < lights[j].center.x;
+    });
+    std::vector<float> xs(n);
+    for (int k = 0; k < n; ++k)
+        xs[k] = lights[by_x[k]].center.x;
+    double max_length = 0;
+    for (const auto& light : lights)
+        max_length = std::max(max_length, light.length);
+    const double max_distance = std::max(a.max_small_center_distance, a.max_large_center_distance);
+    const LightPointIndex index(lights);
+
+    std::vector<int> partners;
+    for (int i = 0; i < n; ++i) {
+        const Light& light_1 = lights[i];
+        // isArmor needs center distance < max_distance * average length, and the length ratio
+        // bounds the partner's length. Pad the reach so float rounding never prunes a valid pair
+        double partner_length = max_length;
+        if (a.min_light_ratio > 0)
+            partner_length = std::min(max_length, light_1.length / a.min_light_ratio);
+        const double reach = max_distance * (light_1.length + partner_length) / 2 * 1.001 + 1.0;
+        if (!(reach >= 0))
+            continue; // NaN length: isArmor rejects every pair anyway
+
+        partners.clear();
+        auto lo = std::lower_bound(xs.begin(), xs.end(), float(light_1.center.x - reach));
+        for (auto it = lo; it != xs.end() && *it <= light_1.center.x + reach; ++it) {
+            const int j = by_x[it - xs.begin()];
+            if (j > i && std::abs(lights[j].center.y - light_1.center.y) <= reach)
+                partners.push_back(j);
+        }
+        // Ascending j keeps the original pair order
+        std::sort(partners.begin(), partners.end());
+
+        for (const int j : partners) {
+            const Light& light_2 = lights[j];
+            auto type            = isArmor(light_1, light_2);
+            if (type == ArmorType::INVALID)
+                continue;
+            auto points =
+                std::vector<cv::Point2f>{light_1.top, light_1.bottom, light_2.top, light_2.bottom};
+            if (index.containsOther(cv::boundingRect(points), lights, light_1, light_2))
+                continue;
+            auto armor = Armor(light_1, light_2);
+            armor.type = type;
+            armors.emplace_back(armor);
+        }
+    }
+
+    return armors;
+}
+
+std::vector<Armor> Detector::matchLightsReference(const std::vector<Light>& lights) const {
     std::vector<Armor> armors;
 
     // Loop all the pairing of lights
@@ -124,7 +358,7 @@ std::vector<Armor> Detector::matchLights(const std::vector<Light>& lights) {
 
 // Check if there is another light in the boundingRect formed by the 2 lights
 bool Detector::containLight(
-    const Light& light_1, const Light& light_2, const std::vector<Light>& lights) {
+    const Light& light_1, const Light& light_2, const std::vector<Light>& lights) const {
     auto points =
         std::vector<cv::Point2f>{light_1.top, light_1.bottom, light_2.top, light_2.bottom};
     auto bounding_rect = cv::boundingRect(points);
@@ -142,7 +376,7 @@ bool Detector::containLight(
     return false;
 }
 
-ArmorType Detector::isArmor(const Light& light_1, const Light& light_2) {
+ArmorType Detector::isArmor(const Light& light_1, const Light& light_2) const {
     // Ratio of the length of 2 lights (short side / long side)
     float light_length_ratio = light_1.length < light_2.length ? light_1.length / light_2.length
                                                                : light_2.length / light_1.length;
@@ -174,13 +408,13 @@ ArmorType Detector::isArmor(const Light& light_1, const Light& light_2) {
     return type;
 }
 
-cv::Mat Detector::getAllNumbersImage() {
-    if (armors_.empty()) {
+cv::Mat Detector::Result::getAllNumbersImage() const {
+    if (armors.empty()) {
         return cv::Mat(cv::Size(20, 28), CV_8UC1);
     } else {
         std::vector<cv::Mat> number_imgs;
-        number_imgs.reserve(armors_.size());
-        for (auto& armor : armors_) {
+        number_imgs.reserve(armors.size());
+        for (auto& armor : armors) {
             number_imgs.emplace_back(armor.number_img);
         }
         cv::Mat all_num_img;
@@ -189,9 +423,9 @@ cv::Mat Detector::getAllNumbersImage() {
     }
 }
 
-void Detector::drawResults(cv::Mat& img) {
+void Detector::Result::drawResults(cv::Mat& img) const {
     // Draw Lights
-    for (const auto& light : lights_) {
+    for (const auto& light : lights) {
         cv::circle(img, light.top, 3, cv::Scalar(255, 255, 255), 1);
         cv::circle(img, light.bottom, 3, cv::Scalar(255, 255, 255), 1);
         auto line_color = light.color == RED ? cv::Scalar(255, 255, 0) : cv::Scalar(255, 0, 255);
@@ -199,16 +433,22 @@ void Detector::drawResults(cv::Mat& img) {
     }
 
     // Draw armors
-    for (const auto& armor : armors_) {
+    for (const auto& armor : armors) {
         cv::line(img, armor.left_light.top, armor.right_light.bottom, cv::Scalar(0, 255, 0), 2);
         cv::line(img, armor.left_light.bottom, armor.right_light.top, cv::Scalar(0, 255, 0), 2);
     }
 
-    // Show numbers and confidence
-    for (const auto& armor : armors_) {
+    // Show numbers and confidence (classify leaves the text empty, build it only here)
+    for (const auto& armor : armors) {
+        if (armor.number.empty())
+            continue;
+        const std::string text =
+            armor.classfication_result.empty()
+                ? cv::format("%s: %.1f%%", armor.number.c_str(), armor.confidence * 100.0)
+                : armor.classfication_result;
         cv::putText(
-            img, armor.classfication_result, armor.left_light.top, cv::FONT_HERSHEY_SIMPLEX, 0.8,
-            cv::Scalar(0, 255, 255), 2);
+            img, text, armor.left_light.top, cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(0, 255, 255),
+            2);
     }
 }
 
@@ -10,6 +10,7 @@
 
 // STD
 #include <cmath>
+#include <memory>
 #include <vector>
 
 #include "detector/armor.hpp"
@@ -24,6 +25,12 @@ public:
         double max_ratio{1.0};
         // vertical angle
         double max_angle{40.0};
+        // Gray: grayscale > binary_thres, then a per-light color vote.
+        // ColorDifference: R - B > color_diff_thres and B - R > color_diff_thres masks, computed
+        // in one vectorized pass; lights come out colored, no vote
+        enum class Binarization { Gray, ColorDifference };
+        Binarization binarization{Binarization::Gray};
+        int color_diff_thres{60};
     };
 
     struct ArmorParams {
@@ -37,34 +44,86 @@ public:
         double max_angle{35.0};
     };
 
-    Detector(const int& bin_thres, const LightParams& l, const ArmorParams& a);
-
-    std::vector<Armor> detect(const cv::Mat& input);
-
-    cv::Mat preprocessImage(const cv::Mat& input);
-    std::vector<Light> findLights(const cv::Mat& rbg_img, const cv::Mat& binary_img);
-    std::vector<Armor> matchLights(const std::vector<Light>& lights);
-
-    // For debug usage
-    cv::Mat getAllNumbersImage();
-    void drawResults(cv::Mat& img);
-
-    int binary_thres;
-    LightParams l;
-    ArmorParams a;
-
-    std::unique_ptr<NumberClassifier> classifier;
+    // Pipeline stages, in order; each depends only on the ones before it. With ColorDifference
+    // binarization Gray is a no-op and Binary builds both color masks
+    enum class Stage { Gray, Binary, Contours, Lights, Armors };
+
+    // Intermediates and output of one detect() call. Each caller (thread) owns its own; passing
+    // the same Result again reuses its buffers
+    struct Result {
+        // Gray binarization
+        cv::Mat gray_img;
+        cv::Mat binary_img;
+        // ColorDifference binarization; contours[0, red_contours) come from red_mask
+        cv::Mat red_mask;
+        cv::Mat blue_mask;
+        size_t red_contours = 0;
+
+        std::vector<std::vector<cv::Point>> contours;
+        std::vector<Light> lights;
+        std::vector<Armor> armors;
+
+        // For debug usage
+        cv::Mat getAllNumbersImage() const;
+        void drawResults(cv::Mat& img) const;
+    };
 
-    // Debug msgs
-    cv::Mat binary_img;
+    // The configuration and the classifier are fixed after construction; to change a parameter
+    // build a new Detector (copies are cheap, the classifier is shared)
+    Detector(
+        const int& bin_thres, const LightParams& l, const ArmorParams& a,
+        std::shared_ptr<const NumberClassifier> classifier = nullptr);
+
+    // All member functions are const and keep no per-call state, so one Detector can serve
+    // any number of threads at once
+    std::vector<Armor> detect(const cv::Mat& input) const;
+    void detect(const cv::Mat& input, Result& result) const;
+    // Incremental re-run: recomputes stage `from` and everything after it, reusing the earlier
+    // stages held in result, which must come from a previous run on the same input (e.g. after
+    // a binary_thres change, from = Stage::Binary skips the grayscale conversion)
+    void detect(const cv::Mat& input, Result& result, Stage from) const;
+
+    cv::Mat preprocessImage(const cv::Mat& input) const;
+    std::vector<Light> findLights(const cv::Mat& rbg_img, const cv::Mat& binary_img) const;
+    std::vector<Light> findLights(
+        const cv::Mat& rbg_img, const std::vector<std::vector<cv::Point>>& contours) const;
+    // ColorDifference path: both masks in one pass over the RGB image, then pre-colored lights
+    void colorDifference(const cv::Mat& rgb_img, cv::Mat& red_mask, cv::Mat& blue_mask) const;
+    std::vector<Light> findLights(
+        const cv::Mat& rgb_img, const cv::Mat& red_mask, const cv::Mat& blue_mask) const;
+    std::vector<Armor> matchLights(const std::vector<Light>& lights) const;
+    // Original O(n^3) pairing (every pair, linear containLight scan), kept for verification
+    std::vector<Armor> matchLightsReference(const std::vector<Light>& lights) const;
+    // Color vote of contours[idx] inside rect (which must lie within rgb_img):
+    // RED if the red channel sum over the contour's pixels exceeds the blue one
+    static int lightColor(
+        const cv::Mat& rgb_img, const std::vector<std::vector<cv::Point>>& contours, int idx,
+        const cv::Rect& rect);
+
+    const int binary_thres;
+    const LightParams l;
+    const ArmorParams a;
+
+    // Numbers are not classified when null
+    const std::shared_ptr<const NumberClassifier> classifier;
 
 private:
-    bool isLight(const Light& possible_light);
-    bool containLight(const Light& light_1, const Light& light_2, const std::vector<Light>& lights);
-    ArmorType isArmor(const Light& light_1, const Light& light_2);
-
-    std::vector<Light> lights_;
-    std::vector<Armor> armors_;
+    // Red mask contours first, then blue ones; red_contours is the split
+    static void findColorContours(
+        const cv::Mat& red_mask, const cv::Mat& blue_mask,
+        std::vector<std::vector<cv::Point>>& contours, size_t& red_contours);
+    // Lights of contours[0, red_contours) are RED, the rest BLUE
+    std::vector<Light> findLights(
+        const cv::Mat& rgb_img, const std::vector<std::vector<cv::Point>>& contours,
+        size_t red_contours) const;
+    // Light of a contour if it passes isLight and its bounding rect lies inside the image
+    bool toLight(
+        const std::vector<cv::Point>& contour, const cv::Mat& rgb_img, Light& light,
+        cv::Rect& rect) const;
+    bool isLight(const Light& possible_light) const;
+    bool containLight(
+        const Light& light_1, const Light& light_2, const std::vector<Light>& lights) const;
+    ArmorType isArmor(const Light& light_1, const Light& light_2) const;
 };
 
 } // namespace rm_auto_aim
@@ -1,6 +1,10 @@
 // Copyright 2022 Chen Jun
 // Licensed under the MIT License.
 
+// Qt
+#include <QDebug>
+#include <QScopeGuard>
+
 // OpenCV
 #include <opencv2/core.hpp>
 #include <opencv2/core/mat.hpp>
@@ -19,16 +23,41 @@
 #include <string>
 #include <vector>
 
+#include "detector/ai/runtime.hpp"
 #include "detector/armor.hpp"
 #include "number_classifier.hpp"
 
 namespace rm_auto_aim {
 NumberClassifier::NumberClassifier(
     const std::string& model_path, const std::string& label_path, const double thre,
-    const std::vector<std::string>& ignore_classes)
+    const std::vector<std::string>& ignore_classes, Backend backend)
     : threshold(thre)
+    , backend_(backend)
     , ignore_classes_(ignore_classes) {
-    net_ = cv::dnn::readNetFromONNX(model_path);
+    if (backend_ == Backend::OpenVINO) {
+        try {
+            ov::Core& core = ai::sharedCore();
+            auto model     = core.read_model(model_path);
+            // Batch = number of armors in the frame
+            ov::PartialShape shape = model->input().get_partial_shape();
+            if (shape.rank().is_static() && shape.size() > 0) {
+                shape[0] = ov::Dimension::dynamic();
+                model->reshape(shape);
+            }
+            // A tiny MLP: one stream on one thread, so it never claims the cores that
+            // ai::Detector's streams are using
+            compiled_ = core.compile_model(
+                model, "CPU", ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY),
+                ov::num_streams(1), ov::inference_num_threads(1));
+            idle_requests_.push_back(compiled_.create_infer_request());
+        } catch (const std::exception& e) {
+            qWarning() << "NumberClassifier: OpenVINO load failed (" << e.what()
+                       << "), falling back to cv::dnn";
+            backend_ = Backend::OpenCV;
+        }
+    }
+    if (backend_ == Backend::OpenCV)
+        net_ = cv::dnn::readNetFromONNX(model_path);
 
     std::ifstream label_file(label_path);
     std::string line;
@@ -37,7 +66,7 @@ NumberClassifier::NumberClassifier(
     }
 }
 
-void NumberClassifier::extractNumbers(const cv::Mat& src, std::vector<Armor>& armors) {
+void NumberClassifier::extractNumbers(const cv::Mat& src, std::vector<Armor>& armors) const {
     // Light length in image
     const int light_length = 12;
     // Image size after warp
@@ -79,41 +108,39 @@ void NumberClassifier::extractNumbers(const cv::Mat& src, std::vector<Armor>& ar
     }
 }
 
-void NumberClassifier::classify(std::vector<Armor>& armors) {
-    for (auto& armor : armors) {
-        cv::Mat image = armor.number_img.clone();
-
-        // Normalize
-        image = image / 255.0;
-
-        // Create blob from image
-        cv::Mat blob;
-        cv::dnn::blobFromImage(image, blob);
-
-        // Set the input blob for the neural network
-        net_.setInput(blob);
-        // Forward pass the image blob through the model
-        cv::Mat outputs = net_.forward();
-
-        // Do softmax
-        float max_prob = *std::max_element(outputs.begin<float>(), outputs.end<float>());
-        cv::Mat softmax_prob;
-        cv::exp(outputs - max_prob, softmax_prob);
-        float sum = static_cast<float>(cv::sum(softmax_prob)[0]);
-        softmax_prob /= sum;
-
-        double confidence;
-        cv::Point class_id_point;
-        minMaxLoc(softmax_prob.reshape(1, 1), nullptr, &confidence, nullptr, &class_id_point);
-        int label_id = class_id_point.x;
-
-        armor.confidence = confidence;
+void NumberClassifier::classify(std::vector<Armor>& armors) const {
+    if (armors.empty())
+        return;
+
+    // One NCHW blob for every ROI of the frame, one forward pass. number_img is the Otsu output
+    // (0 / 255), so scaling by 1/255 gives the same 0 / 1 input as the old per-armor image / 255
+    std::vector<cv::Mat> images;
+    images.reserve(armors.size());
+    for (const auto& armor : armors)
+        images.push_back(armor.number_img);
+    cv::Mat blob;
+    cv::dnn::blobFromImages(images, blob, 1.0 / 255.0);
+    cv::Mat outputs = forward(blob).reshape(1, int(armors.size()));
+
+    // Softmax over all rows: subtract each row's max, one cv::exp for the whole matrix
+    cv::Mat row_max;
+    cv::reduce(outputs, row_max, 1, cv::REDUCE_MAX);
+    cv::Mat softmax_prob;
+    cv::subtract(outputs, cv::repeat(row_max, 1, outputs.cols), softmax_prob);
+    cv::exp(softmax_prob, softmax_prob);
+
+    for (int i = 0; i < softmax_prob.rows; ++i) {
+        const float* prob = softmax_prob.ptr<float>(i);
+        const int label_id = int(std::max_element(prob, prob + softmax_prob.cols) - prob);
+        float sum = 0.f;
+        for (int c = 0; c < softmax_prob.cols; ++c)
+            sum += prob[c];
+
+        auto& armor      = armors[i];
+        armor.confidence = prob[label_id] / sum;
         armor.number     = class_names_[label_id];
-
-        std::stringstream result_ss;
-        result_ss << armor.number << ": " << std::fixed << std::setprecision(1)
-                  << armor.confidence * 100.0 << "%";
-        armor.classfication_result = result_ss.str();
+        // Display text is built on demand (Detector::drawResults)
+        armor.classfication_result.clear();
     }
 
     // armors.erase(
@@ -142,4 +169,38 @@ void NumberClassifier::classify(std::vector<Armor>& armors) {
     //     armors.end());
 }
 
+cv::Mat NumberClassifier::forward(const cv::Mat& blob) const {
+    if (backend_ == Backend::OpenCV) {
+        std::lock_guard lock(mutex_);
+        // The output may alias the net's buffers, which the next forward() overwrites
+        net_.setInput(blob);
+        return net_.forward().clone();
+    }
+
+    ov::InferRequest request;
+    {
+        std::lock_guard lock(mutex_);
+        if (idle_requests_.empty()) {
+            request = compiled_.create_infer_request();
+        } else {
+            request = std::move(idle_requests_.back());
+            idle_requests_.pop_back();
+        }
+    }
+    // Back to the pool on every exit, so a failed infer() doesn't leak the request
+    const auto release = qScopeGuard([&] {
+        std::lock_guard lock(mutex_);
+        idle_requests_.push_back(std::move(request));
+    });
+    // Wrap the blob without copying; the output is copied out before the request is reused
+    const ov::Shape shape(blob.size.p, blob.size.p + blob.dims);
+    request.set_input_tensor(
+        ov::Tensor(ov::element::f32, shape, const_cast<float*>(blob.ptr<float>())));
+    request.infer();
+    const ov::Tensor out = request.get_output_tensor();
+    const int n          = int(shape[0]);
+
+    return cv::Mat(n, int(out.get_size()) / n, CV_32F, out.data<float>()).clone();
+}
+
 } // namespace rm_auto_aim
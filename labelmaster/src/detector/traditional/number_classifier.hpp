@@ -6,10 +6,14 @@
 // OpenCV
 #include <opencv2/opencv.hpp>
 
+// OpenVINO
+#include <openvino/openvino.hpp>
+
 // STL
 #include <cstddef>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -20,18 +24,36 @@ namespace rm_auto_aim
 class NumberClassifier
 {
 public:
+  // OpenVINO compiles on the process-wide ai::sharedCore(), so the classifier shares the CPU
+  // plugin's thread pool with ai::Detector. If it cannot load the model, cv::dnn is used instead
+  enum class Backend { OpenVINO, OpenCV };
+
   NumberClassifier(
     const std::string & model_path, const std::string & label_path, const double threshold,
-    const std::vector<std::string> & ignore_classes = {"negative"});
+    const std::vector<std::string> & ignore_classes = {"negative"},
+    Backend backend = Backend::OpenVINO);
 
-  void extractNumbers(const cv::Mat & src, std::vector<Armor> & armors);
+  // Both are const and safe to call from several threads on one instance
+  void extractNumbers(const cv::Mat & src, std::vector<Armor> & armors) const;
 
-  void classify(std::vector<Armor> & armors);
+  void classify(std::vector<Armor> & armors) const;
 
   double threshold;
 
+  // Backend actually in use (after a possible fallback)
+  Backend backend() const { return backend_; }
+
 private:
-  cv::dnn::Net net_;
+  // N x num_classes logits for an N x 1 x H x W blob
+  cv::Mat forward(const cv::Mat & blob) const;
+
+  Backend backend_;
+  // cv::dnn::Net is not reentrant, so forward() serializes on it; OpenVINO callers each take
+  // an idle request (created on demand) and run in parallel. Both guarded by mutex_
+  mutable cv::dnn::Net net_;
+  ov::CompiledModel compiled_;
+  mutable std::mutex mutex_;
+  mutable std::vector<ov::InferRequest> idle_requests_;
   std::vector<std::string> class_names_;
   std::vector<std::string> ignore_classes_;
 };
@@ -2,16 +2,71 @@
 #include "detector/smart_detector.hpp"
 #include "logger/core.hpp"
 #include "service/file.hpp"
+#include "service/prelabel.hpp"
 #include "ui/image_canvas.hpp"
 #include "ui/mainwindow.hpp"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCoreApplication>
 #include <QFile>
+#include <QThread>
+#include <cstring>
 #include <pthread.h>
 #include <qglobal.h>
 
 #define ASSETS_PATH "/home/developer/ws/assets"
 
+// 命令行里带 --prelabel 时不创建任何窗口
+static bool isHeadless(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--prelabel") == 0
+            || std::strncmp(argv[i], "--prelabel=", 11) == 0)
+            return true;
+    return false;
+}
+
+// LabelMaster --prelabel <dir> [--jobs N] [--assets <dir>] [--profile <name>] [--input-size S]
+//             [--model <file>]
+static int runHeadless(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    logger::Logger::installQtHandler();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ATLabelMaster headless pre-labeling");
+    parser.addHelpOption();
+    const QCommandLineOption prelabel(
+        "prelabel", "Pre-label every image under <dir> (recursive).", "dir");
+    const QCommandLineOption jobs(
+        "jobs", "Worker threads.", "N", QString::number(QThread::idealThreadCount()));
+    const QCommandLineOption assets(
+        "assets", "Assets directory containing models/.", "dir",
+        controller::AppSettings::instance().assetsDir());
+    const QCommandLineOption profile(
+        "profile", "interactive-latency | batch-throughput | low-power.", "name",
+        controller::AppSettings::instance().prelabelProfile());
+    const QCommandLineOption input_size(
+        "input-size", "Network input size: 320 | 416 | 640 | 960.", "px",
+        QString::number(controller::AppSettings::instance().inputSize()));
+    const QCommandLineOption model(
+        "model", "Model file name under <assets>/models/.", "file",
+        controller::AppSettings::instance().detectorModel());
+    parser.addOptions({prelabel, jobs, assets, profile, input_size, model});
+    parser.process(app);
+
+    PrelabelService::Options opt;
+    opt.image_dir  = parser.value(prelabel);
+    opt.assets_dir = parser.value(assets);
+    opt.jobs       = parser.value(jobs).toInt();
+    opt.profile    = parser.value(profile);
+    opt.input_size = parser.value(input_size).toInt();
+    opt.model      = parser.value(model);
+    return PrelabelService().run(opt);
+}
+
 int main(int argc, char* argv[]) {
+    if (isHeadless(argc, argv))
+        return runHeadless(argc, argv);
+
     // 1) 先安装 Qt 的全局消息处理器，尽早捕获日志
     QApplication app(argc, argv);
 
@@ -20,7 +75,24 @@ int main(int argc, char* argv[]) {
     FileService files;
     rm_auto_aim::Detector::LightParams lp;
     rm_auto_aim::Detector::ArmorParams ap;
-    SmartDetector detector{&w};
+    // 检测器跑在独立线程上，避免推理阻塞 GUI；无 parent 才能 moveToThread
+    QThread detector_thread;
+    detector_thread.setObjectName("detector");
+    auto* detector = new SmartDetector;
+    detector->moveToThread(&detector_thread);
+    QObject::connect(&detector_thread, &QThread::finished, detector, &QObject::deleteLater);
+    // 模型在检测线程上编译，窗口先显示；就绪后才启用智能标注
+    QObject::connect(&detector_thread, &QThread::started, detector, &SmartDetector::initialize);
+    QObject::connect(detector, &SmartDetector::modelReady, &w, &ui::MainWindow::setDetectorReady);
+    // 检测模型：后台编译后在检测线程上替换，成功后才保存为默认
+    QObject::connect(
+        detector, &SmartDetector::modelsDiscovered, &w, &ui::MainWindow::setModelList);
+    QObject::connect(detector, &SmartDetector::modelChanged, &w, [&w](const QString& name) {
+        w.setCurrentModel(name);
+        controller::AppSettings::instance().setDetectorModel(name);
+    });
+    QObject::connect(&w, &ui::MainWindow::sigModelRequested, detector, &SmartDetector::selectModel);
+    detector_thread.start();
     // if (QFile::exists(assets_dir)) {
     //     QString model_path = assets_dir + "/models/mlp.onnx";
     //     QString label_path = assets_dir + "/models/label.txt";
@@ -50,10 +122,54 @@ int main(int argc, char* argv[]) {
     QObject::connect(&files, &FileService::busy, &w, &ui::MainWindow::setBusy);
 
     // ImageCanvas <-> SmartDetector 连接 检测和检测结果
+    // submit / setActiveFrame 自带锁，直接在 GUI 线程调用，只入队不阻塞
+    QObject::connect(
+        w.ui()->label, &ImageCanvas::detectRequested, detector, &SmartDetector::submit,
+        Qt::DirectConnection);
+    QObject::connect(
+        w.ui()->label, &ImageCanvas::frameChanged, detector, &SmartDetector::setActiveFrame,
+        Qt::DirectConnection);
+    QObject::connect(
+        detector, &SmartDetector::detected, w.ui()->label, &ImageCanvas::setFrameDetections);
+    // 预取：切图时把后几张的路径交给检测线程，画布记下源路径以便命中缓存
+    QObject::connect(&files, &FileService::imageOpened, w.ui()->label, &ImageCanvas::setImagePath);
+    QObject::connect(
+        &files, &FileService::prefetchRequested, detector, &SmartDetector::prefetch,
+        Qt::DirectConnection);
+    QObject::connect(detector, &SmartDetector::error, &w, [](const QString& msg) { LOGE(msg); });
+    // 性能配置：GUI 线程保存设置，检测线程重新编译
+    w.setPerformanceProfile(controller::AppSettings::instance().performanceProfile());
+    QObject::connect(
+        &w, &ui::MainWindow::sigPerformanceProfileRequested, detector,
+        &SmartDetector::setPerformanceProfile);
+    QObject::connect(
+        &w, &ui::MainWindow::sigPerformanceProfileRequested, &w, [](const QString& name) {
+            controller::AppSettings::instance().setPerformanceProfile(name);
+        });
+    // 融合模式：传统检测器在检测线程上按需创建
+    w.setEnsemble(controller::AppSettings::instance().ensembleMode());
+    QObject::connect(
+        &w, &ui::MainWindow::sigEnsembleRequested, detector, &SmartDetector::setEnsemble);
+    QObject::connect(&w, &ui::MainWindow::sigEnsembleRequested, &w, [](bool on) {
+        controller::AppSettings::instance().setEnsembleMode(on);
+    });
+    // 二值化阈值：检测线程防抖后只重算当前帧的二值化及之后的阶段
+    w.setBinaryThreshold(controller::AppSettings::instance().binaryThreshold());
     QObject::connect(
-        w.ui()->label, &ImageCanvas::detectRequested, &detector, &SmartDetector::detect);
+        &w, &ui::MainWindow::sigBinaryThresholdRequested, detector,
+        &SmartDetector::setBinaryThreshold);
+    QObject::connect(&w, &ui::MainWindow::sigBinaryThresholdRequested, &w, [](int thres) {
+        controller::AppSettings::instance().setBinaryThreshold(thres);
+    });
+    // 输入尺寸档位：各档编译结果缓存在检测线程，切回时不再编译。
+    // 菜单勾选和设置都跟随检测器实际生效的尺寸，切换失败时回到原档位
+    w.setInputSize(controller::AppSettings::instance().inputSize());
     QObject::connect(
-        &detector, &SmartDetector::detected, w.ui()->label, &ImageCanvas::setDetections);
+        &w, &ui::MainWindow::sigInputSizeRequested, detector, &SmartDetector::setInputSize);
+    QObject::connect(detector, &SmartDetector::inputSizeChanged, &w, [&w](int size) {
+        w.setInputSize(size);
+        controller::AppSettings::instance().setInputSize(size);
+    });
     //
     QObject::connect(
         &files, &FileService::labelsLoaded, w.ui()->label, &ImageCanvas::setDetections);
@@ -64,5 +180,8 @@ int main(int argc, char* argv[]) {
     w.show();
 
     LOGI("App started");
-    return app.exec();
+    const int ret = app.exec();
+    detector_thread.quit();
+    detector_thread.wait();
+    return ret;
 }
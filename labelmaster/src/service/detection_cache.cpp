@@ -0,0 +1,206 @@
+// ===============================
+// File: service/detection_cache.cpp
+// ===============================
+#include "service/detection_cache.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <vector>
+
+#include "logger/core.hpp"
+
+namespace {
+constexpr quint32 kMagic   = 0x41544443; // "ATDC"
+constexpr quint16 kVersion = 1;
+constexpr auto kSuffix     = ".det";
+
+// dir 下所有条目的总大小
+qint64 entriesSize(const QString& dir) {
+    qint64 bytes = 0;
+    QDirIterator it(dir, {QString("*") + kSuffix}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        bytes += it.fileInfo().size();
+    }
+    return bytes;
+}
+} // namespace
+
+DetectionCache::DetectionCache(const QString& root, qint64 max_bytes)
+    : root_(root)
+    , max_bytes_(max_bytes) {
+    // 只在这里整体统计一次，之后换指纹不再扫描
+    const QStringList dirs = ownedDirs();
+    for (const QString& dir : dirs)
+        bytes_ += entriesSize(dir);
+    LOGI(QString("检测结果缓存：%1（%2 个指纹，%3 MB）")
+             .arg(root_)
+             .arg(dirs.size())
+             .arg(bytes_ / (1024.0 * 1024.0), 0, 'f', 1));
+}
+
+void DetectionCache::setFingerprint(const QByteArray& fingerprint) {
+    const QString dir = QDir(root_).filePath(QString::fromLatin1(fingerprint));
+    if (dir == dir_)
+        return;
+    dir_ = dir;
+    QFile marker(QDir(dir_).filePath(kMarker));
+    if (marker.exists())
+        return;
+    // 新指纹（或旧版本留下、还没有标记的同名目录）：打上标记，已有条目计入总大小
+    QDir().mkpath(dir_);
+    if (!marker.open(QIODevice::WriteOnly) || marker.write(fingerprint) != fingerprint.size()) {
+        LOGW(QString("无法创建检测结果缓存目录：%1").arg(dir_));
+        dir_.clear();
+        return;
+    }
+    bytes_ += entriesSize(dir_);
+}
+
+QStringList DetectionCache::ownedDirs() const {
+    QStringList dirs;
+    const QDir r(root_);
+    for (const QString& name : r.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        const QString dir = r.filePath(name);
+        if (QFile::exists(QDir(dir).filePath(kMarker)))
+            dirs.push_back(dir);
+    }
+    return dirs;
+}
+
+QByteArray DetectionCache::fileHash(const QString& path) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return {};
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    if (!h.addData(&f))
+        return {};
+    return h.result().toHex();
+}
+
+QString DetectionCache::entryPath(const QByteArray& key) const {
+    const QString k = QString::fromLatin1(key);
+    return dir_ + '/' + k.left(2) + '/' + k.mid(2) + kSuffix;
+}
+
+bool DetectionCache::lookup(const QByteArray& key, QVector<Armor>& out) {
+    if (key.size() < 3 || dir_.isEmpty())
+        return false;
+    QFile f(entryPath(key));
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&f);
+    quint32 magic   = 0;
+    quint16 version = 0;
+    quint32 n       = 0;
+    in >> magic >> version >> n;
+    if (magic != kMagic || version != kVersion || in.status() != QDataStream::Ok)
+        return false;
+    QVector<Armor> armors;
+    armors.reserve(qsizetype(std::min<quint32>(n, 1024)));
+    for (quint32 i = 0; i < n && in.status() == QDataStream::Ok; ++i) {
+        Armor a;
+        in >> a.cls >> a.color >> a.score >> a.p0 >> a.p1 >> a.p2 >> a.p3;
+        armors.push_back(std::move(a));
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    // 刷新修改时间，淘汰时按它排序
+    f.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    out = std::move(armors);
+    return true;
+}
+
+void DetectionCache::store(const QByteArray& key, const QVector<Armor>& armors) {
+    if (key.size() < 3 || dir_.isEmpty() || max_bytes_ <= 0)
+        return;
+    const QString path = entryPath(key);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    const qint64 old = QFileInfo(path).size(); // 不存在时为 0
+
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return;
+    QDataStream out(&f);
+    out << kMagic << kVersion << quint32(armors.size());
+    for (const Armor& a : armors)
+        out << a.cls << a.color << a.score << a.p0 << a.p1 << a.p2 << a.p3;
+    const qint64 size = f.size();
+    if (!f.commit()) {
+        LOGW(QString("写入检测结果缓存失败：%1").arg(path));
+        return;
+    }
+
+    bytes_ += size - old;
+    if (bytes_ > max_bytes_)
+        evict();
+}
+
+// 所有指纹目录一起按修改时间淘汰，一次淘汰到上限的 90%，避免每次写入都扫目录
+void DetectionCache::evict() {
+    struct Entry {
+        QString path;
+        qint64 mtime;
+        qint64 size;
+        int dir; // dirs 中的下标
+    };
+    std::vector<Entry> entries;
+    qint64 total           = 0;
+    const QStringList dirs = ownedDirs();
+    std::vector<int> remaining(dirs.size(), 0); // 每个指纹目录剩余的条目数
+    for (int d = 0; d < int(dirs.size()); ++d) {
+        QDirIterator it(
+            dirs[d], {QString("*") + kSuffix}, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            const QFileInfo fi = it.fileInfo();
+            entries.push_back(
+                {fi.filePath(), fi.lastModified().toMSecsSinceEpoch(), fi.size(), d});
+            total += fi.size();
+            ++remaining[d];
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.mtime < b.mtime;
+    });
+
+    const qint64 target = max_bytes_ / 10 * 9;
+    size_t removed      = 0;
+    for (const Entry& e : entries) {
+        if (total <= target)
+            break;
+        if (QFile::remove(e.path)) {
+            total -= e.size;
+            --remaining[e.dir];
+            ++removed;
+        }
+    }
+    bytes_ = total;
+
+    // 条目删光的旧指纹目录连同标记一起去掉。rmdir 只删空目录，混进了别的文件就原样保留
+    for (int i = 0; i < int(dirs.size()); ++i) {
+        if (dirs[i] == dir_ || remaining[i] > 0)
+            continue;
+        QDir d(dirs[i]);
+        for (const QString& sub : d.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+            d.rmdir(sub);
+        if (d.entryList(QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot)
+            == QStringList{kMarker}) {
+            QFile::remove(d.filePath(kMarker));
+            QDir(root_).rmdir(d.dirName());
+        }
+    }
+    LOGI(QString("检测结果缓存淘汰 %1 条，剩余 %2 MB")
+             .arg(removed)
+             .arg(bytes_ / (1024.0 * 1024.0), 0, 'f', 1));
+}
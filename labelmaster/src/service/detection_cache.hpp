@@ -0,0 +1,48 @@
+// ===============================
+// File: service/detection_cache.hpp
+// ===============================
+#pragma once
+#include "types.hpp" // Armor 定义
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 持久化的检测结果缓存：<root>/<模型指纹>/<hash 前两位>/<hash 其余>.det，每个键一个文件，
+// 查找即一次 open，O(1)。每个指纹一个目录，切换模型或参数只是换当前目录，其它指纹的结果
+// 留着，切回来照样命中。所有指纹共用一个总大小上限，超出时按文件修改时间（命中时会刷新）
+// 淘汰最久未用的条目，近似 LRU。
+// 只动自己建的目录（里面有 kMarker 标记文件），而且只删 .det 条目和清空后的目录，
+// root 下的其它文件一概不碰。总大小在构造时统计一次，之后随写入和淘汰维护。
+// 非线程安全：只在一个线程里使用（SmartDetector 的检测线程）。
+class DetectionCache {
+public:
+    static constexpr auto kMarker = ".detcache";
+
+    DetectionCache(const QString& root, qint64 max_bytes);
+
+    // 图片文件内容的 SHA-1（hex）；读失败返回空
+    static QByteArray fileHash(const QString& path);
+
+    // 切到该指纹的目录，不存在时创建并打上标记；不扫描目录
+    void setFingerprint(const QByteArray& fingerprint);
+    void setMaxBytes(qint64 max_bytes) { max_bytes_ = max_bytes; }
+
+    // 未设置指纹时不命中、不写入
+    bool lookup(const QByteArray& key, QVector<Armor>& out);
+    void store(const QByteArray& key, const QVector<Armor>& armors);
+
+    const QString& root() const { return root_; }
+    qint64 sizeBytes() const { return bytes_; }
+
+private:
+    QString entryPath(const QByteArray& key) const;
+    // root 下带标记文件的指纹目录
+    QStringList ownedDirs() const;
+    void evict();
+
+    QString root_;
+    QString dir_; // 当前指纹目录
+    qint64 max_bytes_ = 0;
+    qint64 bytes_     = 0; // 所有指纹目录下条目的总大小
+};
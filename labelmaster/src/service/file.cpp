@@ -11,6 +11,7 @@
 #include <QImage>
 #include <QImageReader>
 #include <QQueue>
+#include <QSaveFile>
 #include <QSettings>
 #include <QSortFilterProxyModel>
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -179,6 +180,8 @@ FileService::~FileService() = default;
 // ---------- 模型暴露 ----------
 void FileService::exposeModel() { emit modelReady(proxy_); }
 
+const QStringList& FileService::imageNameFilters() { return kImgExt; }
+
 // ---------- 打开入口 ----------
 void FileService::openFolderDialog() {
     const QString dir = QFileDialog::getExistingDirectory(nullptr, tr("选择图片文件夹"));
@@ -231,6 +234,7 @@ bool FileService::openFileAt(const QModelIndex& proxyIndex) {
     }
 
     emit imageReady(img);
+    emit imageOpened(path);
     emit status(tr("已打开：%1").arg(QFileInfo(path).fileName()), 800);
 
     currentImagePath_ = path;       // 记住路径（保存时用）
@@ -246,9 +250,28 @@ bool FileService::openFileAt(const QModelIndex& proxyIndex) {
     } else {
         emit labelsLoaded({});
     }
+
+    // 标注员基本逐张往后翻，提前检测后面几张；每次切图都会整体替换预取列表
+    emit prefetchRequested(upcomingImages(controller::AppSettings::instance().prefetchCount()));
     return true;
 }
 
+QStringList FileService::upcomingImages(int k) const {
+    QStringList paths;
+    if (k <= 0 || !proxyCurrent_.isValid())
+        return paths;
+    const QModelIndex parent = proxyCurrent_.parent().isValid()
+                                 ? proxyCurrent_.parent()
+                                 : static_cast<QModelIndex>(proxyRoot_);
+    const int rows = proxy_->rowCount(parent);
+    for (int r = proxyCurrent_.row() + 1; r < rows && paths.size() < k; ++r) {
+        const QModelIndex s = mapFromProxyToSource(proxy_->index(r, 0, parent));
+        if (s.isValid() && !fsModel_->isDir(s) && isImageFile(fsModel_->filePath(s)))
+            paths << fsModel_->filePath(s);
+    }
+    return paths;
+}
+
 void FileService::openIndex(const QModelIndex& proxyIndex) {
     if (!proxyIndex.isValid())
         return;
@@ -503,8 +526,9 @@ bool FileService::writeLabelFile(
         return false;
 
     QDir().mkpath(QFileInfo(labelPath).absolutePath());
-    QFile f(labelPath);
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    // QSaveFile：中途被打断不会留下半截文件（预标注据此判断是否已完成）
+    QSaveFile f(labelPath);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text))
         return false;
 
     QTextStream ts(&f);
@@ -528,7 +552,8 @@ bool FileService::writeLabelFile(
         ts << colorId << ' ' << labelTk << ' ' << q0.x() << ' ' << q0.y() << ' ' << q1.x() << ' '
            << q1.y() << ' ' << q2.x() << ' ' << q2.y() << ' ' << q3.x() << ' ' << q3.y() << '\n';
     }
-    return true;
+    ts.flush();
+    return f.commit();
 }
 
 QVector<Armor> FileService::readLabelFile(const QString& labelPath, const QSize& imgSize) {
@@ -23,6 +23,15 @@ public:
 
     void exposeModel(); // 把 proxy 模型抛给 UI
 
+    // 支持的图片后缀（QDir name filter 形式）
+    static const QStringList& imageNameFilters();
+
+    // 标注 I/O（归一化支持），也供无界面预标注使用
+    static QString labelFileForImage(const QString& imagePath);
+    static bool writeLabelFile(
+        const QString& labelPath, const QVector<Armor>& armors,
+        const QSize& imgSize); // 保存为归一化，写临时文件后原子替换
+
 public slots:
     // === 打开 ===
     void openFolderDialog();            // 弹框选目录
@@ -51,6 +60,10 @@ signals:
     // === 打开图片时加载到的标注 ===
     void labelsLoaded(const QVector<Armor>& armors);
 
+    // === 预取 ===
+    void imageOpened(const QString& path);            // 紧跟 imageReady，给出图片的源路径
+    void prefetchRequested(const QStringList& paths); // 浏览顺序上的后 K 张（可能为空）
+
 private:
     bool openDir(const QString& dir);
     bool openFileAt(const QModelIndex& proxyIndex);
@@ -59,16 +72,12 @@ private:
     QModelIndex mapFromProxyToSource(const QModelIndex&) const;
     QModelIndex mapFromSourceToProxy(const QModelIndex&) const;
     bool isImageFile(const QString& path) const;
+    QStringList upcomingImages(int k) const; // 与 next() 相同的顺序
 
     // 记忆 & 恢复
     void saveLastVisited(const QString& imagePath);
     void tryRestoreLastVisited(); // 异步调用
 
-    // 标注 I/O（归一化支持）
-    static QString labelFileForImage(const QString& imagePath);
-    static bool writeLabelFile(
-        const QString& labelPath, const QVector<Armor>& armors,
-        const QSize& imgSize); // 保存为归一化
     static QVector<Armor> readLabelFile(
         const QString& labelPath,
         const QSize& imgSize); // 自动反归一化
@@ -0,0 +1,145 @@
+// ===============================
+// File: service/prelabel.cpp
+// ===============================
+#include "service/prelabel.hpp"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QSize>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <opencv2/imgcodecs.hpp>
+#include <thread>
+#include <vector>
+
+#include "controller/settings.hpp"
+#include "detector/ai/detector.hpp"
+#include "detector/ai/model_registry.hpp"
+#include "logger/core.hpp"
+#include "service/file.hpp"
+
+namespace {
+// 最近秩法求分位数，v 需已排序
+double percentile(const std::vector<double>& v, double p) {
+    if (v.empty())
+        return 0.0;
+    const size_t k = size_t(std::ceil(p / 100.0 * v.size()));
+    return v[std::clamp<size_t>(k, 1, v.size()) - 1];
+}
+} // namespace
+
+int PrelabelService::run(const Options& opt) {
+    if (!QDir(opt.image_dir).exists()) {
+        LOGE(QString("预标注目录不存在：%1").arg(opt.image_dir));
+        return 1;
+    }
+
+    // 1) 收集待处理图片（已有标注的跳过）
+    QStringList todo;
+    int skipped = 0;
+    QDirIterator it(
+        opt.image_dir, FileService::imageNameFilters(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        if (QFile::exists(FileService::labelFileForImage(path)))
+            ++skipped;
+        else
+            todo << path;
+    }
+    todo.sort();
+    LOGI(QString("预标注：待处理 %1 张，已有标注跳过 %2 张").arg(todo.size()).arg(skipped));
+    if (todo.isEmpty())
+        return 0;
+
+    // 2) 加载模型
+    const auto& settings = controller::AppSettings::instance();
+    ai::Detector detector;
+    detector.setCacheDir(settings.modelCacheDir());
+    detector.setProfile(ai::Detector::profileFromName(
+        opt.profile.isEmpty() ? settings.prelabelProfile() : opt.profile));
+    detector.setInputSize(opt.input_size > 0 ? opt.input_size : settings.inputSize());
+    const ai::ModelRegistry registry(opt.assets_dir);
+    const QString model_name = opt.model.isEmpty() ? settings.detectorModel() : opt.model;
+    if (const ai::ModelInfo* m = registry.find(model_name))
+        detector.loadModel(m->path, m->mode);
+    else if (!opt.model.isEmpty())
+        LOGW(QString("找不到模型 %1，改用默认模型").arg(opt.model));
+    if (!detector.ready())
+        detector.setupModel(opt.assets_dir);
+    if (!detector.ready()) {
+        LOGE(QString("模型加载失败：%1/models").arg(opt.assets_dir));
+        return 1;
+    }
+    ai::NmsParams nms;
+    nms.iou_threshold = settings.nmsIouThreshold();
+    nms.polygon_iou   = settings.nmsPolygonIou();
+    detector.setNmsParams(nms);
+    ai::Detector::TileParams tiles;
+    tiles.enabled = settings.tiledInference();
+    tiles.tile    = settings.tileSize();
+    tiles.overlap = settings.tileOverlap();
+    detector.setTileParams(tiles);
+
+    // 3) 多线程：读图 → 检测 → 写标注；detector 内部的请求池负责并发推理
+    const int jobs = std::max(1, opt.jobs);
+    std::atomic<qsizetype> next{0};
+    std::atomic<int> done{0}, failed{0};
+    std::vector<double> latency_ms(todo.size(), -1.0);
+
+    const auto t_begin = std::chrono::steady_clock::now();
+    auto worker        = [&] {
+        for (qsizetype i = next++; i < todo.size(); i = next++) {
+            const auto t0      = std::chrono::steady_clock::now();
+            const QString path = todo.at(i);
+            cv::Mat img        = cv::imread(path.toStdString(), cv::IMREAD_COLOR);
+            if (img.empty()) {
+                LOGW(QString("读取失败：%1").arg(path));
+                ++failed;
+                continue;
+            }
+            const QVector<Armor> armors = detector.detect(img);
+            if (!FileService::writeLabelFile(
+                    FileService::labelFileForImage(path), armors, QSize(img.cols, img.rows))) {
+                LOGW(QString("写入标注失败：%1").arg(path));
+                ++failed;
+                continue;
+            }
+            latency_ms[size_t(i)] =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0)
+                    .count();
+            const int n = ++done;
+            if (n % 500 == 0)
+                LOGI(QString("预标注进度：%1 / %2").arg(n).arg(todo.size()));
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(jobs);
+    for (int i = 0; i < jobs; ++i)
+        pool.emplace_back(worker);
+    for (auto& t : pool)
+        t.join();
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t_begin).count();
+
+    // 4) 统计
+    std::vector<double> lat;
+    lat.reserve(latency_ms.size());
+    for (double v : latency_ms)
+        if (v >= 0)
+            lat.push_back(v);
+    std::sort(lat.begin(), lat.end());
+    std::printf(
+        "prelabel: %d done, %d failed, %d skipped, %d jobs, %.1f s\n"
+        "throughput: %.2f images/s\n"
+        "latency ms: p50 %.1f  p95 %.1f  p99 %.1f  max %.1f\n",
+        done.load(), failed.load(), skipped, jobs, elapsed,
+        elapsed > 0 ? done.load() / elapsed : 0.0, percentile(lat, 50), percentile(lat, 95),
+        percentile(lat, 99), lat.empty() ? 0.0 : lat.back());
+    std::fflush(stdout);
+    return failed > 0 ? 2 : 0;
+}
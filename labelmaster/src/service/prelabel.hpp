@@ -0,0 +1,23 @@
+// ===============================
+// File: service/prelabel.hpp
+// ===============================
+#pragma once
+#include <QString>
+
+// 无界面批量预标注：遍历目录下所有图片，多线程跑 ai::Detector，
+// 结果按 FileService::writeLabelFile 的归一化格式写到 ../label/。
+// 已有标注文件的图片直接跳过，因此中断后重新运行即可续跑。
+class PrelabelService {
+public:
+    struct Options {
+        QString image_dir;  // 图片根目录（递归）
+        QString assets_dir; // 含 models/ 的资源目录
+        int jobs = 1;       // 工作线程数
+        QString profile;    // 性能配置名（ai::Detector::Profile），空则取 AppSettings
+        int input_size = 0; // 网络输入尺寸档位，0 则取 AppSettings
+        QString model;      // 模型文件名（ai::ModelInfo::name），空则取 AppSettings，仍为空用默认模型
+    };
+
+    // 返回进程退出码：0 成功；1 初始化失败；2 部分图片失败
+    int run(const Options& opt);
+};
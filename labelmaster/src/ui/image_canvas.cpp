@@ -72,6 +72,7 @@ bool ImageCanvas::loadImage(const QString& path) {
 void ImageCanvas::setImage(const QImage& img) {
     img_ = img;
     imgPath_.clear();
+    emit frameChanged(++frameId_);
 
     // 切图即清空标注
     clearDetections();
@@ -133,9 +134,9 @@ void ImageCanvas::resetView() {
 void ImageCanvas::requestDetect() {
     const QImage crop = cropRoi();
     if (!crop.isNull())
-        emit detectRequested(crop);
+        emit detectRequested(crop, frameId_, {});
     else
-        emit detectRequested(img_);
+        emit detectRequested(img_, frameId_, imgPath_);
 }
 
 /* ===== 外部读写 ===== */
@@ -154,6 +155,13 @@ void ImageCanvas::setDetections(const QVector<Armor>& dets) {
     emit detectionSelected(selectedIndex_);
     update();
 }
+void ImageCanvas::setFrameDetections(quint64 frame_id, const QVector<Armor>& dets) {
+    if (frame_id != frameId_) {
+        qDebug() << "drop stale detections of frame" << frame_id << "(current" << frameId_ << ")";
+        return;
+    }
+    setDetections(dets);
+}
 void ImageCanvas::clearDetections() {
     dets_.clear();
     selectedIndex_ = -1;
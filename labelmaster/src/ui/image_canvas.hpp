@@ -23,8 +23,10 @@ public:
     // 图像与 ROI
     bool loadImage(const QString& path);
     void setImage(const QImage& img);
+    void setImagePath(const QString& path) { imgPath_ = path; } // 不切帧，只记录当前图像的源文件
     const QImage& currentImage() const { return img_; }
     QString currentImagePath() const { return imgPath_; }
+    quint64 frameId() const { return frameId_; } // 每次 setImage 自增，用于匹配异步检测结果
 
     void setModelInputSize(const QSize& s);
     void setRoiMode(RoiMode m);
@@ -44,6 +46,7 @@ public slots:
 
     // 检测结果显示/外部读写
     void setDetections(const QVector<Armor>& dets);  // 覆盖全部
+    void setFrameDetections(quint64 frame_id, const QVector<Armor>& dets); // 非当前帧则丢弃
     void clearDetections();
     void addDetection(const Armor& a);               // 追加一个
     void updateDetection(int index, const Armor& a); // 更新一个
@@ -60,8 +63,10 @@ signals:
     void roiChanged(const QRect& roiImg);
     void roiCommitted(const QRect& roiImg);
 
-    // 检测请求
-    void detectRequested(const QImage& image);
+    // 检测请求（frame_id 随结果回传）；source_path 仅在检测整张原图时非空，供结果缓存使用
+    void detectRequested(const QImage& image, quint64 frame_id, const QString& source_path);
+    // 切换到新图像
+    void frameChanged(quint64 frame_id);
 
     // 新框提交（松手即提交）
     void annotationCommitted(const Armor&);
@@ -121,6 +126,7 @@ private:
     // 图像
     QImage img_;
     QString imgPath_;
+    quint64 frameId_ = 0;
 
     // 视图
     double scale_ = 1.0;
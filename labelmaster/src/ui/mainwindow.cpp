@@ -2,6 +2,7 @@
 #include "logger/core.hpp"
 
 #include <QAction>
+#include <QActionGroup>
 #include <QApplication>
 #include <QDateTime>
 #include <QHeaderView>
@@ -13,6 +14,8 @@
 #include <QMimeData>
 #include <QPixmap>
 #include <QPlainTextEdit>
+#include <QSignalBlocker>
+#include <QSlider>
 #include <QStringListModel>
 #include <QTreeView>
 #include <QUrl>
@@ -63,6 +66,9 @@ MainWindow::MainWindow(QWidget* parent)
 
     // 智能标注
     connect(this, &MainWindow::sigSmartAnnotateRequested, ui_->label, &ImageCanvas::requestDetect);
+    // 模型在后台加载，就绪前禁用
+    ui_->actionSmart->setEnabled(false);
+    ui_->smart_button->setEnabled(false);
 
     statusBar()->showMessage(tr("Ready"), 1200);
 }
@@ -135,6 +141,52 @@ void MainWindow::setRoot(const QModelIndex& idx) {
     emit sigTreeRootChanged(idx);
 }
 
+void MainWindow::setDetectorReady(bool ready) {
+    ui_->actionSmart->setEnabled(ready);
+    ui_->smart_button->setEnabled(ready);
+    if (ready)
+        statusBar()->showMessage(tr("Detector ready"), 2000);
+    else
+        statusBar()->showMessage(tr("Detector unavailable"));
+}
+
+void MainWindow::setPerformanceProfile(const QString& name) {
+    for (QAction* act : ui_->menuProfile->actions())
+        act->setChecked(act->data().toString() == name);
+}
+
+void MainWindow::setInputSize(int size) {
+    for (QAction* act : ui_->menuInputSize->actions())
+        act->setChecked(act->data().toInt() == size);
+}
+
+void MainWindow::setModelList(const QStringList& names, const QString& current) {
+    ui_->menuModel->clear(); // 动作归菜单所有，一并删除，也随之离开 modelGroup_
+    for (const QString& name : names) {
+        // 文件名里的 & 转义成字面量显示；身份用 data，平台主题可能给 text 插入快捷键 &
+        QAction* act = ui_->menuModel->addAction(QString(name).replace('&', "&&"));
+        act->setData(name);
+        act->setCheckable(true);
+        act->setChecked(name == current);
+        modelGroup_->addAction(act);
+    }
+    ui_->menuModel->setEnabled(!names.isEmpty());
+}
+
+void MainWindow::setCurrentModel(const QString& name) {
+    for (QAction* act : ui_->menuModel->actions())
+        act->setChecked(act->data().toString() == name);
+    setStatus(tr("Model: %1").arg(name));
+}
+
+void MainWindow::setEnsemble(bool on) { ui_->actionEnsemble->setChecked(on); }
+
+void MainWindow::setBinaryThreshold(int thres) {
+    const QSignalBlocker blocker(ui_->threshold_slider);
+    ui_->threshold_slider->setValue(thres);
+    ui_->threshold_label->setText(tr("二值化阈值：%1").arg(thres));
+}
+
 void MainWindow::setStatus(const QString& msg, int ms) { statusBar()->showMessage(msg, ms); }
 
 void MainWindow::setBusy(bool on) {
@@ -227,7 +279,7 @@ void MainWindow::keyPressEvent(QKeyEvent* e) {
         e->accept();
         return;
     case Qt::Key_Space:
-        emit sigSmartAnnotateRequested();
+        ui_->actionSmart->trigger(); // 模型未就绪时 action 处于禁用状态，不会触发
         e->accept();
         return;
     case Qt::Key_F1:
@@ -305,6 +357,53 @@ void MainWindow::setupActions() {
     connect(ui_->actionDelete, &QAction::triggered, this, &MainWindow::sigDeleteRequested);
     connect(ui_->actionSmart, &QAction::triggered, this, &MainWindow::sigSmartAnnotateRequested);
     connect(ui_->actionSettings, &QAction::triggered, this, &MainWindow::sigSettingsRequested);
+
+    // 性能模式三选一，data 为 ai::Detector::Profile 的名称
+    auto* profiles = new QActionGroup(this);
+    const std::pair<QAction*, const char*> kProfiles[] = {
+        {   ui_->actionProfileLatency, "interactive-latency"},
+        {ui_->actionProfileThroughput,    "batch-throughput"},
+        {  ui_->actionProfileLowPower,           "low-power"},
+    };
+    for (const auto& [act, name] : kProfiles) {
+        act->setData(QString(name));
+        profiles->addAction(act);
+    }
+    connect(profiles, &QActionGroup::triggered, this, [this](QAction* act) {
+        emit sigPerformanceProfileRequested(act->data().toString());
+    });
+
+    // 输入尺寸档位四选一，data 为网络输入边长
+    auto* sizes = new QActionGroup(this);
+    const std::pair<QAction*, int> kSizes[] = {
+        {ui_->actionInputSize320, 320},
+        {ui_->actionInputSize416, 416},
+        {ui_->actionInputSize640, 640},
+        {ui_->actionInputSize960, 960},
+    };
+    for (const auto& [act, size] : kSizes) {
+        act->setData(size);
+        sizes->addAction(act);
+    }
+    connect(sizes, &QActionGroup::triggered, this, [this](QAction* act) {
+        emit sigInputSizeRequested(act->data().toInt());
+    });
+
+    // triggered 只在用户操作时发出，setEnsemble 的 setChecked 不会回环
+    connect(ui_->actionEnsemble, &QAction::triggered, this, &MainWindow::sigEnsembleRequested);
+
+    // 拖动过程中逐值发出，合并与防抖由检测线程负责
+    connect(ui_->threshold_slider, &QSlider::valueChanged, this, [this](int thres) {
+        ui_->threshold_label->setText(tr("二值化阈值：%1").arg(thres));
+        emit sigBinaryThresholdRequested(thres);
+    });
+
+    // 检测模型：菜单项在 setModelList 里按扫描结果生成
+    modelGroup_ = new QActionGroup(this);
+    ui_->menuModel->setEnabled(false);
+    connect(modelGroup_, &QActionGroup::triggered, this, [this](QAction* act) {
+        emit sigModelRequested(act->data().toString());
+    });
 }
 
 void MainWindow::wireButtonsToActions() {
@@ -37,6 +37,11 @@ signals:
     void sigDeleteRequested();
     void sigSmartAnnotateRequested();
     void sigSettingsRequested();
+    void sigPerformanceProfileRequested(const QString& name); // 菜单切换性能配置
+    void sigInputSizeRequested(int size);                     // 菜单切换输入尺寸档位
+    void sigModelRequested(const QString& name);              // 菜单切换检测模型
+    void sigEnsembleRequested(bool on);                       // 菜单开关 AI + 传统融合
+    void sigBinaryThresholdRequested(int thres);              // 拖动二值化阈值滑块
     void sigFileActivated(const QModelIndex&);
     void sigDroppedPaths(const QStringList&);
     void sigKeyCommand(const QString&);
@@ -58,6 +63,20 @@ public slots:
     void setBusy(bool on);
     void setUiEnabled(bool on);
     void setRoot(const QModelIndex& idx);
+    // 检测模型就绪后才允许智能标注
+    void setDetectorReady(bool ready);
+    // 勾选当前性能配置（不发信号）
+    void setPerformanceProfile(const QString& name);
+    // 勾选当前输入尺寸档位（不发信号）
+    void setInputSize(int size);
+    // 用扫描到的模型重建“检测模型”菜单并勾选 current
+    void setModelList(const QStringList& names, const QString& current);
+    // 勾选当前模型（不发信号）
+    void setCurrentModel(const QString& name);
+    // 勾选融合模式（不发信号）
+    void setEnsemble(bool on);
+    // 设置二值化阈值滑块（不发信号）
+    void setBinaryThreshold(int thres);
 
     // —— 类别列表 —— 
     void setClassList(const QStringList& names);
@@ -78,6 +97,7 @@ private:
     std::unique_ptr<Ui::MainWindow> ui_;
     bool logTimestamp_   = true;
     bool dragDropEnabled_ = true;
+    QActionGroup* modelGroup_ = nullptr; // “检测模型”菜单的单选组
 
     // 类别
     QStringListModel* clsModel_ = nullptr;
@@ -1,18 +1,73 @@
 #pragma once
+#include "detector/ai/preprocess.hpp" // ai::PixelOrder
 #include <opencv2/imgproc.hpp>
 #include <QImage>
+#include <QtGlobal>
 
-cv::Mat qimageToMat(const QImage& img) {
-    if (img.isNull()) return {};
-    QImage converted = img.convertToFormat(QImage::Format_RGB888);
-    cv::Mat mat(converted.height(), converted.width(), CV_8UC3,
-                const_cast<uchar*>(converted.bits()), converted.bytesPerLine());
+// QImage 像素的非拥有视图。mat 直接指向 holder 的像素内存，holder 是 QImage 的浅拷贝，
+// 只增加引用计数，视图存活期间像素不会被释放；原 QImage 之后若被修改会自行 detach，视图不受影响。
+struct QImageView {
+    cv::Mat mat; // CV_8UC3 或 CV_8UC4
+    ai::PixelOrder order = ai::PixelOrder::BGR;
+    QImage holder;
+};
+
+// 按格式显式处理，常见格式零拷贝：
+//   RGB32 / ARGB32（小端内存序 B,G,R,A）→ 8UC4 BGR，QImageReader 读 JPEG/PNG 的默认格式
+//   RGBX8888 / RGBA8888 → 8UC4 RGB；RGB888 → 8UC3 RGB；BGR888 → 8UC3 BGR
+// 预乘 alpha、灰度、索引色等其余格式先转换一次成 RGB888
+inline QImageView qimageView(const QImage& img) {
+    QImageView v;
+    if (img.isNull())
+        return v;
+    switch (img.format()) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+        v.holder = img;
+        v.order  = ai::PixelOrder::BGR;
+        break;
+#endif
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888:
+    case QImage::Format_RGB888:
+        v.holder = img;
+        v.order  = ai::PixelOrder::RGB;
+        break;
+    case QImage::Format_BGR888:
+        v.holder = img;
+        v.order  = ai::PixelOrder::BGR;
+        break;
+    default:
+        v.holder = img.convertToFormat(QImage::Format_RGB888);
+        v.order  = ai::PixelOrder::RGB;
+        break;
+    }
+    const int type = v.holder.depth() == 32 ? CV_8UC4 : CV_8UC3;
+    // constBits()：bits() 会让共享的 QImage detach，等于又拷贝一次
+    v.mat = cv::Mat(
+        v.holder.height(), v.holder.width(), type, const_cast<uchar*>(v.holder.constBits()),
+        size_t(v.holder.bytesPerLine()));
+    return v;
+}
+
+// 拷贝出一份独立的 BGR 8UC3，从视图一遍转换
+inline cv::Mat qimageToMat(const QImage& img) {
+    const QImageView v = qimageView(img);
+    if (v.mat.empty())
+        return {};
+    const bool rgb = v.order == ai::PixelOrder::RGB;
     cv::Mat bgr;
-    cv::cvtColor(mat, bgr, cv::COLOR_RGB2BGR);
-    return bgr.clone();
+    if (v.mat.channels() == 4)
+        cv::cvtColor(v.mat, bgr, rgb ? cv::COLOR_RGBA2BGR : cv::COLOR_BGRA2BGR);
+    else if (rgb)
+        cv::cvtColor(v.mat, bgr, cv::COLOR_RGB2BGR);
+    else
+        bgr = v.mat.clone();
+    return bgr;
 }
 
-QImage matToQImage(const cv::Mat& m) {
+inline QImage matToQImage(const cv::Mat& m) {
     if (m.empty()) return {};
     cv::Mat rgb;
     if (m.type() == CV_8UC3) {